@@ -0,0 +1,132 @@
+// Integrator microbenchmark, not part of the game build.
+// Times the old three separate raymath passes against the fused kernel on every SIMD level this CPU supports.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/bench/bench_integrator.cpp game/src/integrator.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp -o bench_integrator -pthread
+//   ./bench_integrator
+
+#include "raylib.h"
+#include "raymath.h"
+#include "integrator.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+struct BenchBodies
+{
+    std::vector<Vector2> position;
+    std::vector<Vector2> velocity;
+    std::vector<Vector2> force;
+    std::vector<float> mass;
+    std::vector<float> invMass;
+    std::vector<unsigned char> asleep;
+};
+
+// Roughly what the game looks like, mostly moving bodies with the odd static one
+static BenchBodies makeBodies(int count)
+{
+    BenchBodies bodies;
+    unsigned int seed = 12345;
+    auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+
+    for (int i = 0; i < count; i++)
+    {
+        float mass = 1.0f + random() * 9.0f;
+        bool isStatic = (i % 16) == 0;
+
+        bodies.position.push_back({ random() * 1200.0f, random() * 800.0f });
+        bodies.velocity.push_back({ random() * 200.0f - 100.0f, random() * 200.0f - 100.0f });
+        bodies.force.push_back({ 0, 0 });
+        bodies.mass.push_back(mass);
+        bodies.invMass.push_back(isStatic ? 0.0f : 1.0f / mass);
+        bodies.asleep.push_back(0);
+    }
+
+    return bodies;
+}
+
+// resetNetForces, addGravityForce and addKinematics as they were before the fused kernel
+static void threePass(BenchBodies& bodies, Vector2 gravity, float dt)
+{
+    int count = (int)bodies.position.size();
+
+    for (int i = 0; i < count; i++)
+        bodies.force[i] = { 0, 0 };
+
+    for (int i = 0; i < count; i++)
+    {
+        if (bodies.invMass[i] == 0.0f) continue;
+        bodies.force[i] += gravity * bodies.mass[i];
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (bodies.invMass[i] == 0.0f) continue;
+        bodies.position[i] += bodies.velocity[i] * dt;
+        bodies.velocity[i] += bodies.force[i] * bodies.invMass[i] * dt;
+    }
+}
+
+static float checksum(const BenchBodies& bodies)
+{
+    float sum = 0;
+    for (int i = 0; i < bodies.position.size(); i++)
+        sum += bodies.position[i].x + bodies.position[i].y + bodies.velocity[i].x + bodies.velocity[i].y;
+    return sum;
+}
+
+// Best of a few runs, in nanoseconds per body
+template <typename Step>
+static double timeSteps(BenchBodies& bodies, Step step)
+{
+    const long long bodySteps = 50000000;
+    int count = (int)bodies.position.size();
+    int steps = (int)(bodySteps / count) + 1;
+    double best = 1e30;
+
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; s++) step();
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / ((double)steps * count);
+        if (ns < best) best = ns;
+    }
+
+    return best;
+}
+
+int main()
+{
+    const Vector2 gravity = { 0, 100 };
+    const float dt = 1.0f / 60.0f;
+    const int counts[] = { 10000, 100000, 1000000 };
+    const SimdLevel levels[] = { SIMD_SCALAR, SIMD_SSE, SIMD_AVX2 };
+
+    printf("best simd level on this cpu: %s\n\n", SimdLevelName(BestSimdLevel()));
+    printf("%10s  %-12s %10s %14s %9s %14s\n", "bodies", "kernel", "ns/body", "Mbodies/sec", "speedup", "checksum");
+
+    for (int count : counts)
+    {
+        BenchBodies bodies = makeBodies(count);
+        double reference = timeSteps(bodies, [&]() { threePass(bodies, gravity, dt); });
+        printf("%10d  %-12s %10.3f %14.1f %8.2fx %14.6g\n", count, "three-pass", reference, 1000.0 / reference, 1.0, checksum(bodies));
+
+        for (SimdLevel level : levels)
+        {
+            if (!SimdLevelSupported(level)) continue;
+
+            bodies = makeBodies(count);
+            double ns = timeSteps(bodies, [&]()
+            {
+                IntegrateBodies(level, bodies.position.data(), bodies.velocity.data(), bodies.force.data(), bodies.invMass.data(), bodies.asleep.data(), count, gravity, dt);
+            });
+
+            printf("%10d  %-12s %10.3f %14.1f %8.2fx %14.6g\n", count, SimdLevelName(level), ns, 1000.0 / ns, reference / ns, checksum(bodies));
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
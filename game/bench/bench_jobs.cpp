@@ -0,0 +1,160 @@
+// Physics step scaling benchmark, not part of the game build.
+// A floor covered in block stacks with circles raining onto them, stepped with the job system
+// at 1 thread, then doubling up to every hardware thread (or the count given on the command line).
+// Prints ms per step for each stage and the speedup over 1 thread, and hashes the final world
+// so every thread count can be checked against the 1 thread run bit for bit.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/bench/bench_jobs.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/integrator.cpp game/src/islands.cpp game/src/jobs.cpp game/src/narrowphase.cpp game/src/simd.cpp game/src/solver.cpp game/src/determinism.cpp -o bench_jobs -pthread
+//   ./bench_jobs [max threads]
+
+#include "raylib.h"
+#include "bodystore.h"
+#include "broadphase.h"
+#include "determinism.h"
+#include "integrator.h"
+#include "jobs.h"
+#include "narrowphase.h"
+#include "solver.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static const int stackCount = 150;
+static const int stackHeight = 8;
+static const int circleCount = 4000;
+static const int stepCount = 200;
+
+// Static floor, stacks of blocks along it and a field of circles above, every body slightly jittered
+static void makeScene(BodyStore& bodies)
+{
+    unsigned int seed = 777;
+    auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+
+    float width = stackCount * 40.0f;
+
+    int floor = bodies.addBlock({ width * 0.5f, 20 }, { width * 0.5f + 100, 20 }, 0);
+    bodies.setStatic(floor, true);
+
+    for (int s = 0; s < stackCount; s++)
+    {
+        for (int h = 0; h < stackHeight; h++)
+        {
+            bodies.addBlock({ s * 40.0f + 20 + random() * 0.5f, -12.0f - h * 24.0f }, { 12, 12 }, 1);
+        }
+    }
+
+    int columns = (int)(width / 14.0f);
+
+    for (int i = 0; i < circleCount; i++)
+    {
+        Vector2 pos = { (i % columns) * 14.0f + 7 + random() * 2.0f, -400.0f - (i / columns) * 14.0f };
+        bodies.addCircle(pos, 5.0f, 1.0f);
+    }
+}
+
+// Positions and velocities, any difference in any bit changes it
+static uint64_t hashWorld(const BodyStore& bodies)
+{
+    uint64_t hash = HashBytes(bodies.position.data(), bodies.position.size() * sizeof(Vector2));
+    return HashBytes(bodies.velocity.data(), bodies.velocity.size() * sizeof(Vector2), hash);
+}
+
+struct StageTimes
+{
+    double broadphase = 0;
+    double narrowphase = 0;
+    double solve = 0;
+    double integrate = 0;
+
+    double total() const { return broadphase + narrowphase + solve + integrate; }
+};
+
+// Same order as the game's update, minus sleeping so the load stays the same every step
+static StageTimes run(int threads, uint64_t& hash)
+{
+    JobSystem jobs(threads);
+    BodyStore bodies;
+    makeScene(bodies);
+
+    SweepAndPrune sweepAndPrune;
+    NarrowPhase narrowphase;
+    ContactSolver solver;
+    std::vector<AABB> bounds;
+    std::vector<BroadphasePair> pairs;
+    std::vector<Contact> contacts;
+    BroadphaseStats stats;
+
+    Vector2 gravity = { 0, 100 };
+    float dt = 1.0f / 60.0f;
+    StageTimes times;
+
+    typedef std::chrono::steady_clock Clock;
+    auto ms = [](Clock::time_point from, Clock::time_point to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+
+    for (int step = 0; step < stepCount; step++)
+    {
+        auto t0 = Clock::now();
+        bodies.computeBounds(bounds);
+        sweepAndPrune.findPairs(bounds, pairs, &jobs);
+
+        auto t1 = Clock::now();
+        contacts.clear();
+        narrowphase.findContacts(bodies, pairs, contacts, stats, &jobs);
+
+        auto t2 = Clock::now();
+        solver.solve(bodies, contacts, dt, &jobs);
+
+        auto t3 = Clock::now();
+        IntegrateBodies(bodies, gravity, dt, &jobs);
+
+        auto t4 = Clock::now();
+        times.broadphase += ms(t0, t1);
+        times.narrowphase += ms(t1, t2);
+        times.solve += ms(t2, t3);
+        times.integrate += ms(t3, t4);
+    }
+
+    times.broadphase /= stepCount;
+    times.narrowphase /= stepCount;
+    times.solve /= stepCount;
+    times.integrate /= stepCount;
+
+    hash = hashWorld(bodies);
+    return times;
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = argc > 1 ? atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    if (maxThreads < 1) maxThreads = 1;
+
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    printf("%d bodies, %d steps, %u hardware threads\n\n", 1 + stackCount * stackHeight + circleCount, stepCount, std::thread::hardware_concurrency());
+    printf("%7s %8s %8s %8s %8s %9s %8s  %-16s\n", "threads", "broad", "narrow", "solve", "integ", "ms/step", "speedup", "world hash");
+
+    uint64_t referenceHash = 0;
+    double referenceTime = 0;
+
+    for (int i = 0; i < threadCounts.size(); i++)
+    {
+        uint64_t hash;
+        StageTimes times = run(threadCounts[i], hash);
+
+        if (i == 0)
+        {
+            referenceHash = hash;
+            referenceTime = times.total();
+        }
+
+        printf("%7d %8.3f %8.3f %8.3f %8.3f %9.3f %7.2fx  %016llx%s\n", threadCounts[i], times.broadphase, times.narrowphase, times.solve, times.integrate,
+            times.total(), referenceTime / times.total(), (unsigned long long)hash, hash == referenceHash ? "" : "  MISMATCH");
+    }
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Circle narrowphase microbenchmark, not part of the game build.
+// A pile of touching circles like the particle heavy scenes, pairs from the sweep and prune,
+// then the batched kernel timed on every SIMD level this CPU supports.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/bench/bench_narrowphase.cpp game/src/narrowphase.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp -o bench_narrowphase -pthread
+//   ./bench_narrowphase
+
+#include "raylib.h"
+#include "bodystore.h"
+#include "broadphase.h"
+#include "narrowphase.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Grid of circles a little closer than touching, jittered so the normals aren't all axis aligned
+static void makePile(BodyStore& bodies, int count)
+{
+    unsigned int seed = 12345;
+    auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+
+    int columns = 1;
+    while (columns * columns < count) columns++;
+
+    for (int i = 0; i < count; i++)
+    {
+        Vector2 pos = { (i % columns) * 9.0f + random() * 2.0f, (i / columns) * 9.0f + random() * 2.0f };
+        bodies.addCircle(pos, 5.0f, 1.0f);
+    }
+}
+
+// Old CircleOverlap test, one pair at a time with a branch per pair
+static void perPair(const BodyStore& bodies, const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts)
+{
+    for (int i = 0; i < pairs.size(); i++)
+    {
+        int a = pairs[i].a;
+        int b = pairs[i].b;
+        float dx = bodies.position[b].x - bodies.position[a].x;
+        float dy = bodies.position[b].y - bodies.position[a].y;
+        float distance = sqrtf(dx * dx + dy * dy);
+        float overlap = bodies.circles[bodies.shapeIndex[a]].radius + bodies.circles[bodies.shapeIndex[b]].radius - distance;
+
+        if (overlap >= 0)
+        {
+            float inv = 1.0f / distance;
+            Vector2 normal = (distance < 0.001f) ? Vector2{ 0, 1 } : Vector2{ dx * inv, dy * inv };
+            contacts.push_back({ a, b, normal, bodies.position[a], overlap });
+        }
+    }
+}
+
+template <typename Run>
+static double timeRuns(int pairCount, Run run)
+{
+    const long long pairTests = 50000000;
+    int repeats = (int)(pairTests / (pairCount > 0 ? pairCount : 1)) + 1;
+    double best = 1e30;
+
+    for (int attempt = 0; attempt < 5; attempt++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++) run();
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / ((double)repeats * pairCount);
+        if (ns < best) best = ns;
+    }
+
+    return best;
+}
+
+int main()
+{
+    const int counts[] = { 1000, 10000, 100000 };
+    const SimdLevel levels[] = { SIMD_SCALAR, SIMD_SSE, SIMD_AVX2 };
+
+    printf("best simd level on this cpu: %s\n\n", SimdLevelName(BestSimdLevel()));
+    printf("%8s %9s %9s  %-10s %9s %13s %9s\n", "circles", "pairs", "contacts", "kernel", "ns/pair", "Mpairs/sec", "speedup");
+
+    for (int count : counts)
+    {
+        BodyStore bodies;
+        makePile(bodies, count);
+
+        std::vector<AABB> bounds;
+        std::vector<BroadphasePair> pairs;
+        bodies.computeBounds(bounds);
+        SweepAndPrune sweepAndPrune;
+        sweepAndPrune.findPairs(bounds, pairs);
+
+        int pairCount = (int)pairs.size();
+        std::vector<Contact> reference;
+        std::vector<Contact> contacts;
+
+        double baseline = timeRuns(pairCount, [&]() { reference.clear(); perPair(bodies, pairs, reference); });
+        printf("%8d %9d %9d  %-10s %9.3f %13.1f %8.2fx\n", count, pairCount, (int)reference.size(), "per-pair", baseline, 1000.0 / baseline, 1.0);
+
+        for (SimdLevel level : levels)
+        {
+            if (!SimdLevelSupported(level)) continue;
+
+            double ns = timeRuns(pairCount, [&]() { contacts.clear(); FindCircleContacts(bodies, pairs, contacts, level); });
+
+            // Every level has to find the same contacts as the old test, bit for bit
+            bool same = contacts.size() == reference.size();
+            for (int i = 0; same && i < contacts.size(); i++)
+            {
+                same = contacts[i].a == reference[i].a && contacts[i].b == reference[i].b &&
+                       contacts[i].penetration == reference[i].penetration &&
+                       contacts[i].normal.x == reference[i].normal.x && contacts[i].normal.y == reference[i].normal.y;
+            }
+
+            printf("%8d %9d %9d  %-10s %9.3f %13.1f %8.2fx%s\n", count, pairCount, (int)contacts.size(), SimdLevelName(level), ns, 1000.0 / ns, baseline / ns, same ? "" : "  MISMATCH");
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,472 @@
+// Scene benchmark suite, not part of the game build.
+// Builds canned stress scenes at a given size, steps each one for a fixed number of frames and
+// reports how long a step took per body, how many broadphase pairs went by per second and how much
+// heap the scene needed. Scenes are built the same way every time and stepped deterministically,
+// so the hash at the end says whether two runs simulated the same thing.
+//
+// --csv and --json write the results out. --baseline reads a CSV written by an earlier run and
+// flags every scene that got slower (or hungrier) than it by more than --tolerance percent,
+// exiting with 1 so a script can stop on it. A different hash is reported but isn't a regression,
+// it just means the physics changed. Bad options (or --help) print the usage and exit with 2
+// without running anything.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/bench/bench_scenes.cpp game/src/world.cpp game/src/profiler.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/aabbtree.cpp game/src/narrowphase.cpp game/src/solver.cpp game/src/islands.cpp game/src/integrator.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp game/src/ccd.cpp game/src/paircache.cpp game/src/planes.cpp -o bench_scenes -pthread
+//   ./bench_scenes [--scene NAME] [--size N] [--steps N] [--threads N] [--csv FILE] [--json FILE] [--baseline FILE] [--tolerance PCT]
+
+#include "raylib.h"
+#include "jobs.h"
+#include "world.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every heap allocation goes through here so a scene's memory can be measured without asking
+// each system what it holds. Each block carries its size in front of it
+static std::atomic<long long> heapLive(0);
+static std::atomic<long long> heapPeak(0);
+static const size_t heapHeader = 16;
+
+void* operator new(size_t size)
+{
+    char* block = (char*)malloc(size + heapHeader);
+    if (block == nullptr) throw std::bad_alloc();
+
+    *(size_t*)block = size;
+    long long live = heapLive.fetch_add((long long)size) + (long long)size;
+    long long peak = heapPeak.load();
+    while (live > peak && !heapPeak.compare_exchange_weak(peak, live)) {}
+
+    return block + heapHeader;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer == nullptr) return;
+
+    // Through an integer so the compiler doesn't go looking for the header inside the caller's object
+    char* block = (char*)((uintptr_t)pointer - heapHeader);
+    heapLive.fetch_sub((long long)*(size_t*)block);
+    free(block);
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { operator delete(pointer); }
+
+struct SceneOptions
+{
+    const char* scene = nullptr; // every scene when not given
+    int size = 2000; // roughly how many bodies each scene gets
+    int steps = 300;
+    int threads = 0; // every hardware thread
+    const char* csvPath = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    float tolerance = 10; // percent
+};
+
+struct SceneResult
+{
+    std::string scene;
+    int size = 0;
+    int bodies = 0; // after building, before anything fell out
+    int steps = 0;
+    double msPerStep = 0;
+    double nsPerBodyStep = 0;
+    double pairsPerSecond = 0; // broadphase pairs tested
+    double contactsPerStep = 0;
+    long long peakBytes = 0; // most heap the scene had at once, building included
+    unsigned long long hash = 0;
+};
+
+static void printUsage()
+{
+    printf("usage: bench_scenes [--scene NAME] [--size N] [--steps N] [--threads N] [--csv FILE] [--json FILE] "
+        "[--baseline FILE] [--tolerance PCT]\n");
+}
+
+// False for --help, an unknown flag or a flag with nothing after it, after saying why.
+// Running the whole suite on options nobody asked for would pass a --baseline check by accident
+static bool parseOptions(int argc, char** argv, SceneOptions& options)
+{
+    static const char* const flags[] = { "--scene", "--size", "--steps", "--threads", "--csv", "--json", "--baseline", "--tolerance" };
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        const char* flag = argv[i];
+
+        if (strcmp(flag, "--help") == 0 || strcmp(flag, "-h") == 0)
+        {
+            printUsage();
+            return false;
+        }
+
+        bool known = false;
+        for (const char* name : flags)
+        {
+            if (strcmp(flag, name) == 0) known = true;
+        }
+
+        if (!known)
+        {
+            printf("unknown option %s\n", flag);
+            printUsage();
+            return false;
+        }
+
+        if (i + 1 >= argc)
+        {
+            printf("%s needs a value\n", flag);
+            printUsage();
+            return false;
+        }
+
+        const char* text = argv[i + 1];
+        int value = atoi(text);
+
+        if (strcmp(flag, "--scene") == 0) options.scene = text;
+        else if (strcmp(flag, "--size") == 0) options.size = value;
+        else if (strcmp(flag, "--steps") == 0) options.steps = value;
+        else if (strcmp(flag, "--threads") == 0) options.threads = value;
+        else if (strcmp(flag, "--csv") == 0) options.csvPath = text;
+        else if (strcmp(flag, "--json") == 0) options.jsonPath = text;
+        else if (strcmp(flag, "--baseline") == 0) options.baselinePath = text;
+        else if (strcmp(flag, "--tolerance") == 0) options.tolerance = (float)atof(text);
+    }
+
+    return true;
+}
+
+// Circles of a few sizes in a loose grid, falling onto a halfspace floor
+static void buildRain(PhysicsWorld& world, int size)
+{
+    int columns = 100;
+
+    world.addHalfspace({ 0, 0 }, 0);
+
+    for (int i = 0; i < size; i++)
+    {
+        Vector2 pos = { (i % columns) * 20.0f + (i % 3) * 0.5f, -50.0f - (i / columns) * 20.0f };
+        world.addCircle(pos, 4.0f + (i % 4), 1.0f);
+    }
+}
+
+// Side by side pyramids of blocks on a static floor, 20 rows each
+static void buildPyramids(PhysicsWorld& world, int size)
+{
+    const int rows = 20;
+    const float half = 10.0f;
+    int perPyramid = rows * (rows + 1) / 2;
+    int pyramids = (size + perPyramid - 1) / perPyramid;
+    float spacing = rows * half * 2 + 100;
+
+    int floor = world.addBlock({ pyramids * spacing * 0.5f, 50 }, { pyramids * spacing * 0.5f + 100, 50 }, 0);
+    world.bodies.setStatic(floor, true);
+
+    for (int p = 0; p < pyramids; p++)
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            for (int k = 0; k < rows - row; k++)
+            {
+                float x = p * spacing + 50 + row * half + k * half * 2;
+                float y = -half - row * half * 2;
+                world.addBlock({ x, y }, { half, half }, 1.0f);
+            }
+        }
+    }
+}
+
+// Circles and blocks mixed together and dropped into a walled pit, so everything ends up touching
+static void buildPile(PhysicsWorld& world, int size)
+{
+    int columns = (int)sqrtf((float)size) + 1;
+    float width = columns * 16.0f;
+
+    int floor = world.addBlock({ 0, 20 }, { width * 0.5f + 40, 20 }, 0);
+    int left = world.addBlock({ -width * 0.5f - 20, -width }, { 20, width }, 0);
+    int right = world.addBlock({ width * 0.5f + 20, -width }, { 20, width }, 0);
+    world.bodies.setStatic(floor, true);
+    world.bodies.setStatic(left, true);
+    world.bodies.setStatic(right, true);
+
+    for (int i = 0; i < size; i++)
+    {
+        Vector2 pos = { -width * 0.5f + 8 + (i % columns) * 16.0f + (i % 5) * 0.2f, -20.0f - (i / columns) * 16.0f };
+
+        if (i % 3 == 0)
+            world.addBlock(pos, { 5.0f + (i % 2), 5.0f }, 1.0f);
+        else
+            world.addCircle(pos, 5.0f + (i % 2), 1.0f);
+    }
+}
+
+// A ring of 64 halfspaces all facing the middle, with circles and blocks falling inside it
+static void buildArena(PhysicsWorld& world, int size)
+{
+    const int planes = 64;
+    float radius = sqrtf((float)size) * 12.0f + 100;
+
+    for (int k = 0; k < planes; k++)
+    {
+        // A normal of (0, -1) rotated by angle - 90 points back at the middle from angle around the ring
+        float angle = 360.0f * k / planes;
+        Vector2 pos = { radius * cosf(angle * DEG2RAD), radius * sinf(angle * DEG2RAD) };
+        world.addHalfspace(pos, angle - 90);
+    }
+
+    int columns = (int)sqrtf((float)size) + 1;
+    float spacing = radius / columns;
+
+    for (int i = 0; i < size; i++)
+    {
+        Vector2 pos = { -radius * 0.5f + (i % columns) * spacing, -radius * 0.5f + (i / columns) * spacing };
+
+        if (i % 4 == 0)
+            world.addBlock(pos, { 4, 4 }, 1.0f);
+        else
+            world.addCircle(pos, 4.0f, 1.0f);
+    }
+}
+
+struct Scene
+{
+    const char* name;
+    void (*build)(PhysicsWorld& world, int size);
+};
+
+static const Scene scenes[] =
+{
+    { "rain", buildRain },
+    { "pyramids", buildPyramids },
+    { "pile", buildPile },
+    { "arena", buildArena },
+};
+
+static SceneResult runScene(const Scene& scene, const SceneOptions& options, JobSystem& jobs)
+{
+    SceneResult result;
+    result.scene = scene.name;
+    result.size = options.size;
+    result.steps = options.steps;
+
+    long long heapBefore = heapLive.load();
+    heapPeak.store(heapBefore);
+
+    long long bodySteps = 0;
+    long long pairsTested = 0;
+    long long contacts = 0;
+    double seconds = 0;
+
+    {
+        PhysicsWorld world;
+        world.jobs = &jobs;
+        world.deterministic = true;
+        world.killY = 5000;
+
+        scene.build(world, options.size);
+        result.bodies = world.bodies.size();
+
+        const float dt = 1.0f / 60.0f;
+
+        for (int i = 0; i < options.steps; i++)
+        {
+            int bodies = world.bodies.size();
+
+            auto start = std::chrono::steady_clock::now();
+            world.step(dt);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            bodySteps += bodies;
+            pairsTested += world.getStats().pairsTested;
+            contacts += (long long)world.getContacts().size();
+        }
+
+        result.hash = world.getRollingHash();
+    }
+
+    result.peakBytes = heapPeak.load() - heapBefore;
+    result.msPerStep = seconds * 1000.0 / options.steps;
+    result.nsPerBodyStep = bodySteps > 0 ? seconds * 1e9 / bodySteps : 0;
+    result.pairsPerSecond = seconds > 0 ? pairsTested / seconds : 0;
+    result.contactsPerStep = (double)contacts / options.steps;
+    return result;
+}
+
+static const char* csvHeader = "scene,size,bodies,steps,ms_per_step,ns_per_body_step,pairs_per_second,contacts_per_step,peak_bytes,hash";
+
+static void writeCSV(FILE* file, const std::vector<SceneResult>& results)
+{
+    fprintf(file, "%s\n", csvHeader);
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        const SceneResult& r = results[i];
+        fprintf(file, "%s,%d,%d,%d,%.4f,%.2f,%.0f,%.1f,%lld,%016llx\n", r.scene.c_str(), r.size, r.bodies, r.steps, r.msPerStep,
+            r.nsPerBodyStep, r.pairsPerSecond, r.contactsPerStep, r.peakBytes, r.hash);
+    }
+}
+
+static void writeJSON(FILE* file, const std::vector<SceneResult>& results)
+{
+    fprintf(file, "[\n");
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        const SceneResult& r = results[i];
+        fprintf(file, "  { \"scene\": \"%s\", \"size\": %d, \"bodies\": %d, \"steps\": %d, \"ms_per_step\": %.4f, \"ns_per_body_step\": %.2f, "
+            "\"pairs_per_second\": %.0f, \"contacts_per_step\": %.1f, \"peak_bytes\": %lld, \"hash\": \"%016llx\" }%s\n",
+            r.scene.c_str(), r.size, r.bodies, r.steps, r.msPerStep, r.nsPerBodyStep, r.pairsPerSecond, r.contactsPerStep,
+            r.peakBytes, r.hash, i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "]\n");
+}
+
+// Reads back what writeCSV wrote, false if the file isn't there or isn't one of ours
+static bool readBaseline(const char* path, std::vector<SceneResult>& baseline)
+{
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) return false;
+
+    char line[512];
+    bool ours = fgets(line, sizeof(line), file) != nullptr && strncmp(line, csvHeader, strlen(csvHeader)) == 0;
+
+    while (ours && fgets(line, sizeof(line), file) != nullptr)
+    {
+        SceneResult r;
+        char scene[64];
+
+        if (sscanf(line, "%63[^,],%d,%d,%d,%lf,%lf,%lf,%lf,%lld,%llx", scene, &r.size, &r.bodies, &r.steps, &r.msPerStep,
+            &r.nsPerBodyStep, &r.pairsPerSecond, &r.contactsPerStep, &r.peakBytes, &r.hash) != 10)
+            continue;
+
+        r.scene = scene;
+        baseline.push_back(r);
+    }
+
+    fclose(file);
+    return ours;
+}
+
+// Prints every scene against the baseline run of the same scene and size, returns how many regressed
+static int compareBaseline(const std::vector<SceneResult>& results, const std::vector<SceneResult>& baseline, float tolerance)
+{
+    int regressions = 0;
+    double limit = 1.0 + tolerance / 100.0;
+
+    printf("\n%-10s %6s %14s %14s %8s %12s  %s\n", "scene", "size", "ns/body-step", "baseline", "change", "peak change", "");
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        const SceneResult& r = results[i];
+        const SceneResult* before = nullptr;
+
+        for (int k = 0; k < baseline.size() && before == nullptr; k++)
+        {
+            if (baseline[k].scene == r.scene && baseline[k].size == r.size) before = &baseline[k];
+        }
+
+        if (before == nullptr)
+        {
+            printf("%-10s %6d %14.2f %14s\n", r.scene.c_str(), r.size, r.nsPerBodyStep, "none");
+            continue;
+        }
+
+        double speed = before->nsPerBodyStep > 0 ? r.nsPerBodyStep / before->nsPerBodyStep : 1;
+        double memory = before->peakBytes > 0 ? (double)r.peakBytes / before->peakBytes : 1;
+        bool slower = speed > limit;
+        bool hungrier = memory > limit;
+        if (slower || hungrier) regressions++;
+
+        printf("%-10s %6d %14.2f %14.2f %+7.1f%% %+11.1f%%  %s%s%s\n", r.scene.c_str(), r.size, r.nsPerBodyStep, before->nsPerBodyStep,
+            (speed - 1) * 100, (memory - 1) * 100, slower ? "SLOWER " : "", hungrier ? "MORE MEMORY " : "",
+            r.hash != before->hash ? "(different hash)" : "");
+    }
+
+    return regressions;
+}
+
+int main(int argc, char** argv)
+{
+    SceneOptions options;
+    if (!parseOptions(argc, argv, options)) return 2;
+    JobSystem jobs(options.threads);
+
+    std::vector<SceneResult> results;
+
+    printf("%d steps per scene on %d threads\n", options.steps, jobs.getThreadCount());
+    printf("%-10s %6s %7s %10s %14s %14s %10s %12s  %s\n", "scene", "size", "bodies", "ms/step", "ns/body-step", "pairs/sec",
+        "contacts", "peak bytes", "hash");
+
+    for (const Scene& scene : scenes)
+    {
+        if (options.scene != nullptr && strcmp(options.scene, scene.name) != 0) continue;
+
+        SceneResult r = runScene(scene, options, jobs);
+        printf("%-10s %6d %7d %10.3f %14.2f %14.0f %10.1f %12lld  %016llx\n", r.scene.c_str(), r.size, r.bodies, r.msPerStep,
+            r.nsPerBodyStep, r.pairsPerSecond, r.contactsPerStep, r.peakBytes, r.hash);
+        results.push_back(r);
+    }
+
+    if (results.empty())
+    {
+        printf("no scene called %s\n", options.scene);
+        return 1;
+    }
+
+    FILE* file;
+
+    if (options.csvPath != nullptr)
+    {
+        if ((file = fopen(options.csvPath, "w")) == nullptr)
+        {
+            printf("can't write %s\n", options.csvPath);
+            return 1;
+        }
+
+        writeCSV(file, results);
+        fclose(file);
+    }
+
+    if (options.jsonPath != nullptr)
+    {
+        if ((file = fopen(options.jsonPath, "w")) == nullptr)
+        {
+            printf("can't write %s\n", options.jsonPath);
+            return 1;
+        }
+
+        writeJSON(file, results);
+        fclose(file);
+    }
+
+    if (options.baselinePath == nullptr) return 0;
+
+    std::vector<SceneResult> baseline;
+
+    if (!readBaseline(options.baselinePath, baseline))
+    {
+        printf("can't read a baseline from %s\n", options.baselinePath);
+        return 1;
+    }
+
+    int regressions = compareBaseline(results, baseline, options.tolerance);
+
+    if (regressions > 0)
+    {
+        printf("%d scene%s regressed by more than %.0f%%\n", regressions, regressions == 1 ? "" : "s", options.tolerance);
+        return 1;
+    }
+
+    printf("nothing regressed by more than %.0f%%\n", options.tolerance);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Snapshot cost benchmark, not part of the game build.
+// Fills a world with circles over a floor at a range of body counts, steps it until it's busy,
+// then times saving and restoring a snapshot. Also checks that a restored world steps to exactly
+// the same hash as the original did, the whole point of rolling back.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/bench/bench_snapshot.cpp game/src/world.cpp game/src/profiler.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/aabbtree.cpp game/src/narrowphase.cpp game/src/solver.cpp game/src/islands.cpp game/src/integrator.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp game/src/ccd.cpp game/src/paircache.cpp game/src/planes.cpp -o bench_snapshot -pthread
+//   ./bench_snapshot [max bodies]
+
+#include "raylib.h"
+#include "world.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static const int warmupSteps = 30;
+static const int resimSteps = 30;
+static const int repeats = 50;
+
+static void makeScene(PhysicsWorld& world, int bodyCount)
+{
+    int columns = 200;
+    float width = columns * 12.0f;
+
+    int floor = world.addBlock({ width * 0.5f, 20 }, { width * 0.5f + 100, 20 }, 0);
+    world.bodies.setStatic(floor, true);
+
+    for (int i = 1; i < bodyCount; i++)
+    {
+        Vector2 pos = { (i % columns) * 12.0f + 6 + (i % 7) * 0.3f, -10.0f - (i / columns) * 12.0f };
+        world.addCircle(pos, 5.0f, 1.0f);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int maxBodies = argc > 1 ? atoi(argv[1]) : 100000;
+
+    typedef std::chrono::steady_clock Clock;
+    auto us = [](Clock::time_point from, Clock::time_point to) { return std::chrono::duration<double, std::micro>(to - from).count(); };
+
+    printf("%8s %10s %10s %10s %12s  %s\n", "bodies", "bytes", "save us", "restore us", "ns/body trip", "resim");
+
+    for (int bodyCount = 100; bodyCount <= maxBodies; bodyCount *= 10)
+    {
+        PhysicsWorld world;
+        world.deterministic = true;
+        makeScene(world, bodyCount);
+
+        for (int i = 0; i < warmupSteps; i++)
+        {
+            world.step(1.0f / 60.0f);
+        }
+
+        WorldSnapshot snapshot;
+        world.saveSnapshot(snapshot); // first save sizes the buffer
+
+        auto t0 = Clock::now();
+        for (int i = 0; i < repeats; i++) world.saveSnapshot(snapshot);
+        auto t1 = Clock::now();
+        for (int i = 0; i < repeats; i++) world.restoreSnapshot(snapshot);
+        auto t2 = Clock::now();
+
+        double save = us(t0, t1) / repeats;
+        double restore = us(t1, t2) / repeats;
+
+        // Step on, roll back, step the same again
+        for (int i = 0; i < resimSteps; i++) world.step(1.0f / 60.0f);
+        uint64_t first = world.getRollingHash();
+
+        world.restoreSnapshot(snapshot);
+        for (int i = 0; i < resimSteps; i++) world.step(1.0f / 60.0f);
+        uint64_t second = world.getRollingHash();
+
+        printf("%8d %10zu %10.1f %10.1f %12.2f  %s\n", bodyCount, snapshot.data.size(), save, restore,
+            (save + restore) * 1000.0 / bodyCount, first == second ? "matches" : "MISMATCH");
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "broadphase.h"
+#include <vector>
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// Slab test of the segment origin + direction * t, t in [0, maxFraction], against a box.
+// On a hit writes the entry fraction to tHit
+bool RaycastAABB(Vector2 origin, Vector2 direction, float maxFraction, const AABB& box, float* tHit);
+
+// Bounding volume hierarchy over fattened AABBs. Leaves are proxies handed out by
+// createProxy(), the tree only needs touching when a body leaves its fat box.
+// The tree balances itself with AVL style rotations so queries stay O(log n).
+class DynamicAABBTree
+{
+public:
+    float fatMargin = 6.0f;
+
+    int createProxy(const AABB& box, int userData);
+    void destroyProxy(int proxyId);
+
+    // Returns true if the proxy left its fat box and was reinserted
+    bool moveProxy(int proxyId, const AABB& box);
+
+    const AABB& getFatAABB(int proxyId) const { return nodes[proxyId].box; }
+    int getUserData(int proxyId) const { return nodes[proxyId].userData; }
+    void setUserData(int proxyId, int userData) { nodes[proxyId].userData = userData; }
+
+    int getHeight() const { return root == nullNode ? 0 : nodes[root].height; }
+    int getProxyCount() const { return proxyCount; }
+
+    // The node array as is, proxy ids stay the same after restoring
+    void save(SnapshotWriter& writer) const;
+    void restore(SnapshotReader& reader);
+
+    // callback(proxyId) for every fat box overlapping box, return false to stop early
+    template <typename Callback>
+    void queryAABB(const AABB& box, Callback callback) const;
+
+    template <typename Callback>
+    void queryPoint(Vector2 point, Callback callback) const
+    {
+        queryAABB({ point, point }, callback);
+    }
+
+    // Walks the segment origin + direction * t for t in [0, maxFraction].
+    // callback(proxyId, maxFraction) returns the new max fraction: the hit fraction to
+    // clip the ray, maxFraction to ignore the proxy, or 0 to stop
+    template <typename Callback>
+    void raycast(Vector2 origin, Vector2 direction, float maxFraction, Callback callback) const;
+
+private:
+    static constexpr int nullNode = -1;
+
+    struct TreeNode
+    {
+        AABB box;
+        int parent; // doubles as the next free node while on the free list
+        int child1;
+        int child2;
+        int height; // leaves are 0, free nodes are -1
+        int userData;
+
+        bool isLeaf() const { return child1 == nullNode; }
+    };
+
+    int allocateNode();
+    void freeNode(int nodeId);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int nodeId);
+    void refit(int nodeId);
+
+    std::vector<TreeNode> nodes;
+    int root = nullNode;
+    int freeList = nullNode;
+    int proxyCount = 0;
+};
+
+// The tree is height balanced so this covers far more proxies than we will ever have
+constexpr int aabbTreeStackSize = 256;
+
+template <typename Callback>
+void DynamicAABBTree::queryAABB(const AABB& box, Callback callback) const
+{
+    if (root == nullNode) return;
+
+    int stack[aabbTreeStackSize];
+    int count = 0;
+    stack[count++] = root;
+
+    while (count > 0)
+    {
+        int nodeId = stack[--count];
+
+        const TreeNode& node = nodes[nodeId];
+        if (!AABBOverlap(node.box, box)) continue;
+
+        if (node.isLeaf())
+        {
+            if (!callback(nodeId)) return;
+        }
+        else
+        {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
+
+template <typename Callback>
+void DynamicAABBTree::raycast(Vector2 origin, Vector2 direction, float maxFraction, Callback callback) const
+{
+    if (root == nullNode) return;
+
+    int stack[aabbTreeStackSize];
+    int count = 0;
+    stack[count++] = root;
+
+    while (count > 0)
+    {
+        int nodeId = stack[--count];
+
+        const TreeNode& node = nodes[nodeId];
+
+        float t;
+        if (!RaycastAABB(origin, direction, maxFraction, node.box, &t)) continue;
+
+        if (node.isLeaf())
+        {
+            float value = callback(nodeId, maxFraction);
+            if (value == 0.0f) return;
+            maxFraction = value;
+        }
+        else
+        {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "raylib.h"
+#include "broadphase.h"
+#include <vector>
+
+class SnapshotReader;
+class SnapshotWriter;
+
+enum PhysicsShape
+{
+    CIRCLE,
+    HALF_SPACE,
+    BLOCK
+};
+
+const int SHAPE_COUNT = BLOCK + 1; // keep this one past the last shape
+
+struct PhysicsMaterial
+{
+    float coefficientOfFriction = 0.5f;
+    float bounciness = 0.9f; // for determing coefficient of restitution
+};
+
+struct CircleShape
+{
+    float radius;
+};
+
+struct BlockShape
+{
+    Vector2 halfExtents;
+};
+
+struct HalfspaceShape
+{
+    // distance to the normal hints: a dot b * (b/||b||) ||b|| referring to magnitude
+    // dot product: a.x * b.x + a.y * b.y
+    Vector2 normal;
+    float rotation; // degrees
+};
+
+// Stable reference to a body. A body's index changes when another body gets removed, its handle
+// doesn't, and a handle to a removed body stops resolving instead of pointing at whatever took its place
+struct BodyHandle
+{
+    int slot = -1;
+    unsigned int generation = 0;
+
+    bool operator==(const BodyHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const BodyHandle& other) const { return !(*this == other); }
+};
+
+// Every body in the world as parallel arrays, one entry per body, so the
+// integration and gravity passes stream straight through memory.
+// Shape data lives in one array per shape type, shapeIndex points into it
+// and the matching owner array points back at the body.
+// Removing a body moves the last body into its place (and the same for its shape), so removal is O(1)
+// but the last body's index changes. Anything holding on to a body across removals should keep a handle
+struct BodyStore
+{
+    std::vector<Vector2> position;
+    std::vector<Vector2> previousPosition; // before the last physics step, drawing blends from here to position
+    std::vector<Vector2> velocity; // Pixels per sec
+    std::vector<Vector2> force; // in Newtons
+    std::vector<float> mass;
+    std::vector<float> invMass; // 0 for static bodies, they don't move according to velocity or gravity
+    std::vector<PhysicsMaterial> material;
+    std::vector<PhysicsShape> shape;
+    std::vector<int> shapeIndex;
+    std::vector<int> proxyId; // leaf in the static or dynamic tree, -1 if none
+    std::vector<Color> color;
+    std::vector<unsigned char> asleep; // 1 while the body's island is sleeping, skipped by integration and narrowphase
+    std::vector<float> sleepTime; // seconds spent slow enough to sleep
+    std::vector<unsigned char> bullet; // 1 to sweep the body's whole step for things it would pass through (circles only)
+    std::vector<int> handleSlot; // the body's slot in the handle table
+
+    std::vector<CircleShape> circles;
+    std::vector<int> circleOwner;
+    std::vector<BlockShape> blocks;
+    std::vector<int> blockOwner;
+    std::vector<HalfspaceShape> halfspaces;
+    std::vector<int> halfspaceOwner;
+
+    int size() const { return (int)position.size(); }
+
+    int addCircle(Vector2 pos, float radius, float bodyMass);
+    int addBlock(Vector2 pos, Vector2 halfExtents, float bodyMass);
+    int addHalfspace(Vector2 pos, float rotationDegrees);
+    void remove(int body);
+    void clear(); // every handle goes stale
+
+    BodyHandle getHandle(int body) const { return { handleSlot[body], slots[handleSlot[body]].generation }; }
+    int indexOf(BodyHandle handle) const; // -1 if the body has been removed
+
+    // Every array including the handle table, so handles saved alongside still resolve after restoring
+    void save(SnapshotWriter& writer) const;
+    void restore(SnapshotReader& reader);
+
+    bool isStatic(int body) const { return invMass[body] == 0.0f; }
+    void setStatic(int body, bool makeStatic);
+
+    // Moving and not asleep, the bodies that actually need simulating
+    bool isAwake(int body) const { return invMass[body] != 0.0f && !asleep[body]; }
+    void wake(int body);
+    void wakeAll();
+    void sleep(int body);
+    void applyImpulse(int body, Vector2 impulse);
+
+    // Call before every physics step so drawing can interpolate between the last two
+    void storePreviousPositions() { previousPosition = position; }
+    Vector2 interpolatedPosition(int body, float alpha) const;
+    void setMass(int body, float bodyMass);
+    void setRotationDegrees(int body, float rotationDegrees);
+
+    // One pass per shape type, bounds ends up indexed by body. Halfspaces get an empty box
+    void computeBounds(std::vector<AABB>& bounds) const;
+    AABB getAABB(int body) const;
+
+private:
+    int addBody(PhysicsShape bodyShape, int bodyShapeIndex, Vector2 pos, float bodyMass);
+    void removeShape(PhysicsShape removedShape, int removedShapeIndex);
+
+    // Handle table. Slots get reused through a free list and bump their generation
+    // every time they're freed, so old handles to the slot stop matching
+    struct HandleSlot
+    {
+        int body; // index while in use, next free slot while free
+        unsigned int generation;
+    };
+
+    std::vector<HandleSlot> slots;
+    int firstFreeSlot = -1;
+};
+
+// Thin views over one body in a BodyStore for gameplay code.
+// A view is just the body index, so it goes stale once any body is removed, keep a BodyHandle instead
+class PhysicsBody
+{
+public:
+    PhysicsBody() = default;
+    PhysicsBody(BodyStore* store, int index) : store(store), index(index) {}
+
+    bool isValid() const { return store != nullptr && index >= 0 && index < store->size(); }
+    int getIndex() const { return index; }
+
+    Vector2& position() const { return store->position[index]; }
+    Vector2& projectileVelo() const { return store->velocity[index]; }
+    Vector2& netForce() const { return store->force[index]; }
+    PhysicsMaterial& material() const { return store->material[index]; }
+
+    float getMass() const { return store->mass[index]; }
+    void setMass(float bodyMass) const { store->setMass(index, bodyMass); }
+    bool isStatic() const { return store->isStatic(index); }
+    void setStatic(bool makeStatic) const { store->setStatic(index, makeStatic); }
+    bool isAsleep() const { return store->asleep[index] != 0; }
+    bool isBullet() const { return store->bullet[index] != 0; }
+    void setBullet(bool sweep) const { store->bullet[index] = sweep ? 1 : 0; }
+    void applyImpulse(Vector2 impulse) const { store->applyImpulse(index, impulse); }
+
+    PhysicsShape Shape() const { return store->shape[index]; }
+
+protected:
+    BodyStore* store = nullptr;
+    int index = -1;
+};
+
+class PhysicsCircle : public PhysicsBody
+{
+public:
+    using PhysicsBody::PhysicsBody;
+
+    float& radius() const { return store->circles[store->shapeIndex[index]].radius; }
+    Color& color() const { return store->color[index]; }
+};
+
+class PhysicsHalfspace : public PhysicsBody
+{
+public:
+    using PhysicsBody::PhysicsBody;
+
+    void setRotationDegrees(float rotationInDeg) const { store->setRotationDegrees(index, rotationInDeg); }
+    float getRotation() const { return store->halfspaces[store->shapeIndex[index]].rotation; }
+    Vector2 getNormal() const { return store->halfspaces[store->shapeIndex[index]].normal; }
+};
+
+class PhysicsBlock : public PhysicsBody
+{
+public:
+    using PhysicsBody::PhysicsBody;
+
+    Vector2& halfExtents() const { return store->blocks[store->shapeIndex[index]].halfExtents; }
+    Color& color() const { return store->color[index]; }
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "raylib.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// Axis aligned bounding box
+struct AABB
+{
+    Vector2 min;
+    Vector2 max;
+};
+
+// Inside out box that overlaps nothing, not even itself. Halfspaces get one so no broadphase
+// ever pairs them, the plane pass tests them against everything instead
+inline AABB EmptyAABB()
+{
+    return { { INFINITY, INFINITY }, { -INFINITY, -INFINITY } };
+}
+
+inline bool AABBIsEmpty(const AABB& box)
+{
+    return box.min.x > box.max.x;
+}
+
+inline bool AABBOverlap(const AABB& a, const AABB& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+           a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+// Two body indices that might be touching, always a < b
+struct BroadphasePair
+{
+    int a;
+    int b;
+};
+
+// Which broadphase checkCollisions uses, switchable at runtime to compare them
+enum BroadphaseMode
+{
+    BROADPHASE_BRUTE_FORCE,
+    BROADPHASE_GRID,
+    BROADPHASE_SWEEP_AND_PRUNE,
+    BROADPHASE_AABB_TREE
+};
+
+// Pairs handed to the narrowphase vs pairs that actually overlapped, for the HUD
+struct BroadphaseStats
+{
+    int pairsTested = 0;
+    int pairsOverlapping = 0;
+};
+
+// Orders pairs by (a, b), every broadphase hands them over like this
+void SortPairs(std::vector<BroadphasePair>& pairs);
+
+// The original all-pairs loop, kept around as the reference to compare against. Empty boxes get left out
+void BruteForcePairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs);
+
+// Spatial hash over a uniform grid, rebuilt every step.
+// Boxes covering too many cells skip the grid and are checked against every other box instead.
+// Empty boxes get skipped altogether.
+class UniformGrid
+{
+public:
+    float cellSize = 64.0f;
+    int maxCellsPerBox = 64;
+
+    // Fills pairs with every pair of overlapping boxes, sorted by (a, b) so the
+    // narrowphase resolves them in the same order as the all-pairs loop did
+    void findPairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs);
+
+private:
+    struct CellEntry
+    {
+        uint64_t cell;
+        int index;
+    };
+
+    std::vector<CellEntry> entries;
+    std::vector<int> oversized;
+};
+
+// Sort and sweep along the x axis. The endpoint list survives between frames and is
+// re-sorted with insertion sort, which is close to linear when bodies barely move
+// (settled towers). Endpoints refer to body indices, so call markDirty() whenever
+// bodies are added or removed. Empty boxes never make it into the sweep.
+// The sweep runs in parallel on jobs when given one: boxes get packed in the order they open
+// and each one scans forward through the boxes opening before it closes, so no box depends on another
+class SweepAndPrune
+{
+public:
+    void findPairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs, JobSystem* jobs = nullptr);
+
+    void markDirty();
+
+private:
+    struct Endpoint
+    {
+        float value;
+        int index;
+        bool isMin;
+    };
+
+    struct SweepBox
+    {
+        float minX;
+        float maxX;
+        float minY;
+        float maxY;
+        int index;
+    };
+
+    void rebuild(const std::vector<AABB>& boxes);
+
+    std::vector<Endpoint> endpoints;
+    std::vector<SweepBox> sweep; // boxes in the order their min endpoints sort
+    std::vector<std::vector<BroadphasePair>> chunkPairs;
+    bool dirty = true;
+};
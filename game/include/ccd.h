@@ -0,0 +1,20 @@
+#pragma once
+
+#include "raylib.h"
+
+// Swept tests for bullets. The circle moves from start by motion over one step and the other
+// shape moves by its own motion (zero for static ones). Everything is worked out in the other
+// shape's frame, so only the relative motion matters.
+// Pairs that already overlap at the start get left to the narrowphase, these only catch
+// the ones a discrete step would jump straight over
+struct TimeOfImpact
+{
+    float fraction = -1; // of the step when they first touch, 0 to 1, -1 for a miss
+    Vector2 normal = { 0, 0 }; // from the other shape out towards the circle when they touch
+};
+
+TimeOfImpact CircleCircleTOI(Vector2 start, Vector2 motion, float radius, Vector2 otherStart, Vector2 otherMotion, float otherRadius);
+TimeOfImpact CircleBlockTOI(Vector2 start, Vector2 motion, float radius, Vector2 blockStart, Vector2 blockMotion, Vector2 halfExtents);
+
+// The plane's normal points out of the solid side
+TimeOfImpact CircleHalfspaceTOI(Vector2 start, Vector2 motion, float radius, Vector2 planePoint, Vector2 planeNormal);
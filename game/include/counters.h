@@ -0,0 +1,51 @@
+#pragma once
+
+// On in debug builds, off in release (NDEBUG) where none of this gets compiled.
+// Build with ENGINE_COUNTERS=0 or 1 to pick either way
+#ifndef ENGINE_COUNTERS
+#ifdef NDEBUG
+#define ENGINE_COUNTERS 0
+#else
+#define ENGINE_COUNTERS 1
+#endif
+#endif
+
+#if ENGINE_COUNTERS
+
+#include "raylib.h"
+
+class PhysicsWorld;
+
+// Everything that says why a frame cost what it did, gathered once a frame.
+// Physics numbers are from the last step of the frame, render numbers from the whole of the last frame
+struct EngineCounters
+{
+    int circles = 0;
+    int blocks = 0;
+    int halfspaces = 0;
+    int asleep = 0;
+
+    int candidatePairs = 0; // out of the broadphase
+    int pairsTested = 0; // by the broadphase, planes count every body against every plane
+    int contacts = 0; // out of the narrowphase and plane pass
+    int manifolds = 0; // touching pairs the solver worked on
+    int velocityIterations = 0;
+    int positionIterations = 0;
+    int physicsSteps = 0; // this frame
+
+    // rlgl, only counted when raylib is built with RLGL_RENDER_STATS (its debug configurations are)
+    int batchFlushes = 0; // rlDrawRenderBatch calls, EndDrawing always makes one
+    int drawCalls = 0;
+    int vertices = 0;
+};
+
+// Physics side, call after the frame's steps
+void GatherPhysicsCounters(const PhysicsWorld& world, int physicsSteps, EngineCounters& counters);
+
+// Render side, call after EndDrawing. Reads and resets rlgl's counts, so the next frame starts from 0
+void GatherRenderCounters(EngineCounters& counters);
+
+// Panel listing all of them
+void DrawEngineCounters(const EngineCounters& counters, Rectangle bounds);
+
+#endif
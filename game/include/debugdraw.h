@@ -0,0 +1,86 @@
+#pragma once
+
+#include "raylib.h"
+#include "broadphase.h"
+#include <vector>
+
+// What a debug primitive is showing, each one can be switched on and off at runtime
+enum DebugCategory : unsigned int
+{
+    DEBUG_FORCES = 1 << 0, // net force and gravity on moving bodies
+    DEBUG_CONTACT_FORCES = 1 << 1, // normal and friction forces from the solver
+    DEBUG_CONTACTS = 1 << 2, // contact points and normals from the narrowphase
+    DEBUG_AABBS = 1 << 3, // broadphase boxes
+    DEBUG_CATEGORY_COUNT = 4
+};
+
+enum DebugPrimitive : unsigned char
+{
+    DEBUG_LINE,
+    DEBUG_ARROW,
+    DEBUG_POINT,
+    DEBUG_BOX
+};
+
+// One recorded primitive. Lines and arrows go from a to b, boxes from min a to max b, points sit on a
+struct DebugCommand
+{
+    Vector2 a;
+    Vector2 b;
+    float size; // line thickness, or point radius
+    Color color;
+    DebugPrimitive type;
+    unsigned char category; // bit index, so turning a category off also hides what it already recorded
+};
+
+// Physics records debug primitives into here as it steps and draw() flushes them all in one batch.
+// Recording is inline and checks the category first so a disabled category costs a branch,
+// and anything recording a whole loop of primitives should check isEnabled once up front instead.
+// Only flush touches rlgl, everything else builds without a window
+class DebugDraw
+{
+public:
+    unsigned int enabled = DEBUG_FORCES | DEBUG_CONTACT_FORCES;
+
+    bool isEnabled(unsigned int category) const { return (enabled & category) != 0; }
+    void toggle(unsigned int category) { enabled ^= category; }
+
+    void line(unsigned int category, Vector2 from, Vector2 to, float thickness, Color color)
+    {
+        if (isEnabled(category)) record(category, DEBUG_LINE, from, to, thickness, color);
+    }
+
+    void arrow(unsigned int category, Vector2 from, Vector2 to, float thickness, Color color)
+    {
+        if (isEnabled(category)) record(category, DEBUG_ARROW, from, to, thickness, color);
+    }
+
+    void point(unsigned int category, Vector2 position, float radius, Color color)
+    {
+        if (isEnabled(category)) record(category, DEBUG_POINT, position, position, radius, color);
+    }
+
+    void box(unsigned int category, const AABB& box, float thickness, Color color)
+    {
+        if (isEnabled(category)) record(category, DEBUG_BOX, box.min, box.max, thickness, color);
+    }
+
+    // Called at the start of every physics step, so the buffer always holds the latest step
+    void clear() { commands.clear(); }
+
+    // Everything recorded in enabled categories as triangles in a single rlBegin/rlEnd
+    void flush() const;
+
+    int getCommandCount() const { return (int)commands.size(); }
+
+private:
+    void record(unsigned int category, DebugPrimitive type, Vector2 a, Vector2 b, float size, Color color)
+    {
+        unsigned char bit = 0;
+        while ((category >> bit) > 1) bit++;
+
+        commands.push_back({ a, b, size, color, type, bit });
+    }
+
+    std::vector<DebugCommand> commands;
+};
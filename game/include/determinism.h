@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Everything the step does is plain IEEE float math in a fixed order: pairs and contacts are
+// sorted by body index, parallel work is split into chunks that don't depend on the thread
+// count and joined in chunk order, and the SIMD paths do the same operations as the scalar
+// ones (no FMA). What's left to pin down is the float environment, which a library or driver
+// can change under us, and the compiler, which has to be told not to contract a * b + c
+// (-ffp-contract=off on GCC/Clang, /fp:precise on MSVC)
+
+// Round to nearest, denormals kept (no flush to zero) on the calling thread
+void SetDeterministicFloatEnvironment();
+
+// True if the calling thread is already in that state
+bool IsDeterministicFloatEnvironment();
+
+// 64 bit hash, 8 bytes at a time, for checking two runs agree bit for bit.
+// Not for anything adversarial, just fast and sensitive to every bit
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// Folds one value into a running hash, order matters
+uint64_t HashCombine(uint64_t hash, uint64_t value);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "raylib.h"
+#include "simd.h"
+
+struct BodyStore;
+class JobSystem;
+
+// Gravity, integration and clearing forces in one sweep over the arrays:
+//   position += velocity * dt
+//   velocity += (force * invMass + gravity) * dt
+//   force = 0
+// Bodies with invMass 0 are static and bodies flagged in asleep are sleeping, only their force gets cleared.
+// Every level gives bit identical results, there is no FMA anywhere
+void IntegrateBodies(SimdLevel level, Vector2* position, Vector2* velocity, Vector2* force, const float* invMass, const unsigned char* asleep, int count, Vector2 gravity, float dt);
+
+// Whole store on the best level, split into ranges on jobs when given one
+void IntegrateBodies(BodyStore& bodies, Vector2 gravity, float dt, JobSystem* jobs = nullptr);
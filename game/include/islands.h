@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+struct BodyStore;
+struct ContactManifold;
+
+// Union-find over body indices, joined wherever a manifold connects two moving bodies.
+// Static bodies never join, a floor would otherwise glue every pile on it into one island
+class IslandGraph
+{
+public:
+    void build(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds);
+
+    // Lowest body index in the island, -1 for static bodies
+    int find(int body);
+
+    // Indices of the awake manifolds grouped island by island, each island keeping the order
+    // the manifolds were in. Island i is order[islandStarts[i]] up to order[islandStarts[i + 1]]
+    void groupManifolds(const std::vector<ContactManifold>& manifolds, std::vector<int>& order, std::vector<int>& islandStarts);
+
+private:
+    std::vector<int> parent;
+    std::vector<int> islandIndex; // per root while grouping
+    std::vector<int> cursor; // per island while grouping
+};
+
+// Groups of moving bodies connected through contacts. A whole island falls asleep once
+// every body in it has been slow for long enough, and wakes up together, so a stack never
+// goes to sleep with one block still moving
+class Islands
+{
+public:
+    bool sleepingEnabled = true;
+    float linearSleepTolerance = 2.0f; // pixels per sec, anything slower counts as resting
+    float timeToSleep = 0.5f; // seconds an island has to rest before it sleeps
+
+    // Wakes every island that has one of these bodies in it. Run before the narrowphase
+    // with last frame's manifolds, sleeping pairs are carried over in there
+    void wake(BodyStore& bodies, const std::vector<int>& bodiesToWake, const std::vector<ContactManifold>& manifolds);
+
+    // Ticks the sleep timers and puts resting islands to sleep. Run after solving and before
+    // integrating so the velocities checked are the ones about to be used
+    void updateSleep(BodyStore& bodies, const std::vector<ContactManifold>& manifolds, float dt);
+
+    // From the last updateSleep, for the HUD
+    int getIslandCount() const { return islandCount; }
+    int getSleepingCount() const { return sleepingCount; }
+
+private:
+    IslandGraph graph;
+    std::vector<float> islandSleepTime; // per root, the shortest sleep time in the island
+    std::vector<unsigned char> islandAwake; // per root
+
+    int islandCount = 0;
+    int sleepingCount = 0;
+};
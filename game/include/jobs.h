@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// How many chunks parallelFor cuts count items into
+inline int JobChunkCount(int count, int grainSize)
+{
+    if (count <= 0) return 0;
+    if (grainSize < 1) grainSize = 1;
+    return (count + grainSize - 1) / grainSize;
+}
+
+// Work stealing thread pool. Every thread has its own deque of jobs: it pushes and pops its own
+// at the back and steals from the front of someone else's once it runs dry, so a thread that
+// finishes early takes work off a busy one instead of sitting idle. The thread calling
+// parallelFor works through the jobs too instead of just waiting, so 1 thread means no workers
+// at all and everything runs inline
+class JobSystem
+{
+public:
+    // 0 means one per hardware thread
+    explicit JobSystem(int threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Counting the calling thread
+    int getThreadCount() const { return threadCount; }
+
+    // Cuts [0, count) into chunks of grainSize, runs fn(begin, end, chunk) on every chunk and
+    // returns once they're all done. The chunks only depend on count and grainSize, never on how
+    // many threads there are, so anything written out per chunk and joined in chunk order comes
+    // out the same with 1 thread or 64. Chunks can call parallelFor again
+    template <typename Fn>
+    void parallelFor(int count, int grainSize, Fn&& fn);
+
+private:
+    typedef void (*JobFunction)(void* context, int chunk);
+
+    void runChunks(JobFunction function, void* context, int chunkCount);
+
+    // Threads, queues and locks live in jobs.cpp. <thread>, <mutex> and even <memory> drag in
+    // <time.h>, whose time() clashes with the game's globals
+    struct Pool;
+    Pool* pool = nullptr;
+    int threadCount = 1;
+};
+
+template <typename Fn>
+void JobSystem::parallelFor(int count, int grainSize, Fn&& fn)
+{
+    int chunkCount = JobChunkCount(count, grainSize);
+    if (grainSize < 1) grainSize = 1;
+
+    auto runChunk = [&](int chunk)
+    {
+        int begin = chunk * grainSize;
+        fn(begin, std::min(begin + grainSize, count), chunk);
+    };
+
+    if (threadCount == 1 || chunkCount == 1)
+    {
+        for (int chunk = 0; chunk < chunkCount; chunk++) runChunk(chunk);
+        return;
+    }
+
+    typedef decltype(runChunk) RunChunk;
+    runChunks([](void* context, int chunk) { (*(RunChunk*)context)(chunk); }, &runChunk, chunkCount);
+}
+
+// Same as jobs->parallelFor, chunk by chunk on this thread when there's no job system
+template <typename Fn>
+void ParallelFor(JobSystem* jobs, int count, int grainSize, Fn&& fn)
+{
+    if (jobs != nullptr)
+    {
+        jobs->parallelFor(count, grainSize, fn);
+        return;
+    }
+
+    int chunkCount = JobChunkCount(count, grainSize);
+    if (grainSize < 1) grainSize = 1;
+
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+        int begin = chunk * grainSize;
+        fn(begin, std::min(begin + grainSize, count), chunk);
+    }
+}
+
+// Joins per chunk results in chunk order, which is what keeps parallel output deterministic
+template <typename T>
+void AppendChunks(const std::vector<std::vector<T>>& chunks, int chunkCount, std::vector<T>& out)
+{
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+        out.insert(out.end(), chunks[chunk].begin(), chunks[chunk].end());
+    }
+}
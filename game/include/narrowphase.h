@@ -0,0 +1,120 @@
+#pragma once
+
+#include "raylib.h"
+#include "bodystore.h"
+#include "broadphase.h"
+#include "simd.h"
+#include <vector>
+
+class JobSystem;
+
+// Two bodies touching. The normal points from a to b
+struct Contact
+{
+    int a;
+    int b;
+    Vector2 normal;
+    Vector2 point; // halfway between the two surfaces
+    float penetration;
+};
+
+// Which contact function a pair of shapes goes through, in either order.
+// Each routine takes its two shapes in the order they're named
+enum ContactRoutine : unsigned char
+{
+    CONTACT_NONE, // halfspace vs halfspace, never collide
+    CONTACT_CIRCLE_CIRCLE,
+    CONTACT_CIRCLE_HALFSPACE,
+    CONTACT_CIRCLE_BLOCK,
+    CONTACT_BLOCK_BLOCK,
+    CONTACT_BLOCK_HALFSPACE,
+    CONTACT_ROUTINE_COUNT
+};
+
+// One cell of the dispatch table. flip means the pair's shapes come the other way round
+// from the routine's, so the bodies get swapped going in and the contact flipped coming out
+struct ContactDispatch
+{
+    ContactRoutine routine;
+    bool flip;
+};
+
+struct ContactDispatchTable
+{
+    ContactDispatch cell[SHAPE_COUNT][SHAPE_COUNT];
+};
+
+// Built at compile time from one line per routine, the mirrored cell gets the flipped entry.
+// A new shape is a new line per shape it collides with, and dispatch stays a single lookup
+constexpr ContactDispatchTable MakeContactDispatchTable()
+{
+    struct RoutineShapes
+    {
+        PhysicsShape first;
+        PhysicsShape second;
+        ContactRoutine routine;
+    };
+
+    const RoutineShapes routines[] = {
+        { CIRCLE, CIRCLE, CONTACT_CIRCLE_CIRCLE },
+        { CIRCLE, HALF_SPACE, CONTACT_CIRCLE_HALFSPACE },
+        { CIRCLE, BLOCK, CONTACT_CIRCLE_BLOCK },
+        { BLOCK, BLOCK, CONTACT_BLOCK_BLOCK },
+        { BLOCK, HALF_SPACE, CONTACT_BLOCK_HALFSPACE },
+    };
+
+    ContactDispatchTable table = {}; // CONTACT_NONE everywhere else
+
+    for (const RoutineShapes& entry : routines)
+    {
+        table.cell[entry.first][entry.second] = { entry.routine, false };
+        if (entry.first != entry.second) table.cell[entry.second][entry.first] = { entry.routine, true };
+    }
+
+    return table;
+}
+
+inline constexpr ContactDispatchTable contactDispatch = MakeContactDispatchTable();
+
+constexpr ContactRoutine ContactRoutineFor(PhysicsShape a, PhysicsShape b)
+{
+    return contactDispatch.cell[a][b].routine;
+}
+
+static_assert(ContactRoutineFor(HALF_SPACE, BLOCK) == CONTACT_BLOCK_HALFSPACE && contactDispatch.cell[HALF_SPACE][BLOCK].flip,
+    "mirrored cells get filled in");
+
+// Circle vs circle contacts for a whole pair list at once. Pairs get gathered a chunk at a time
+// into flat arrays so the kernel tests 4 (SSE) or 8 (AVX2) pairs per instruction with no branches.
+// Nothing gets moved here, resolving the contacts is a separate pass.
+// Every pair has to be circle vs circle, contacts come out in pair order and get appended
+void FindCircleContacts(const BodyStore& bodies, const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts, SimdLevel level = BestSimdLevel());
+
+// Swaps a and b and turns the normal around
+void FlipContact(Contact& contact);
+
+// Contacts for a whole broadphase pair list. Each pair looks its two shapes up in the dispatch
+// table and goes into that routine's batch with its bodies in the routine's order, then every batch
+// runs as one loop over a single contact function (circle vs circle through the SIMD kernel).
+// Halfspaces never come through here, PlanePass does those.
+// Pairs where neither body is awake get skipped, the solver keeps sleeping contacts itself.
+// The list is cut into fixed chunks that run in parallel on jobs when given one, each chunk
+// with its own batches. Chunks are joined back in order so the contacts come out
+// the same whatever the thread count. Contacts get appended, stats get overwritten
+class NarrowPhase
+{
+public:
+    void findContacts(const BodyStore& bodies, const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts,
+        BroadphaseStats& stats, JobSystem* jobs = nullptr);
+
+private:
+    struct ChunkResult
+    {
+        // Bodies in the routine's shape order, so a can be above b in here
+        std::vector<BroadphasePair> batches[CONTACT_ROUTINE_COUNT];
+        std::vector<Contact> contacts;
+        int pairsTested = 0;
+    };
+
+    std::vector<ChunkResult> chunks;
+};
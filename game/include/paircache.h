@@ -0,0 +1,78 @@
+#pragma once
+
+#include "raylib.h"
+#include "bodystore.h"
+#include "narrowphase.h"
+#include <cstdint>
+#include <vector>
+
+struct ContactManifold;
+class SnapshotReader;
+class SnapshotWriter;
+
+// One touching pair as gameplay sees it. Body indices are from when the event was made,
+// -1 for a body already removed by then. Removing bodies afterwards moves indices, the handles stay good
+struct ContactEvent
+{
+    BodyHandle handleA;
+    BodyHandle handleB;
+    int a;
+    int b;
+    ContactRoutine routine;
+    int age; // steps the pair has been touching, 0 when it begins
+    Vector2 normal; // a to b
+    Vector2 point;
+    float normalImpulse; // what the solver applied this step, 0 once the pair ends
+};
+
+// Every touching pair, keyed on the two bodies' handles so the entry survives bodies
+// being removed and indices moving around. The cache is an open addressed hash table
+// (linear probing, kept under half full), updated once a step from the solver's manifolds
+// and turned into begin, persist and end events. Sleeping pairs keep their manifolds so they
+// persist rather than end. Events come out in manifold order, ends sorted by key, so they're
+// the same from run to run
+class PairCache
+{
+public:
+    void update(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds);
+    void clear();
+
+    int getPairCount() const { return pairCount; }
+
+    // From the last update
+    const std::vector<ContactEvent>& getBeginEvents() const { return beginEvents; }
+    const std::vector<ContactEvent>& getPersistEvents() const { return persistEvents; }
+    const std::vector<ContactEvent>& getEndEvents() const { return endEvents; }
+
+    void save(SnapshotWriter& writer) const;
+    void restore(SnapshotReader& reader);
+
+private:
+    struct Entry
+    {
+        uint64_t key; // 0 while empty
+        BodyHandle handleA;
+        BodyHandle handleB;
+        ContactRoutine routine;
+        int age;
+        unsigned int lastUpdate; // update the pair was last touching in
+        Vector2 normal;
+        Vector2 point;
+        float normalImpulse;
+    };
+
+    static uint64_t makeKey(BodyHandle a, BodyHandle b);
+    int findSlot(uint64_t key) const; // the entry holding key, or the empty slot it would go in
+    void erase(int slot);
+    void grow();
+    ContactEvent makeEvent(const BodyStore& bodies, const Entry& entry) const;
+
+    std::vector<Entry> entries; // power of two sized
+    int pairCount = 0;
+    unsigned int updateCount = 0;
+
+    std::vector<ContactEvent> beginEvents;
+    std::vector<ContactEvent> persistEvents;
+    std::vector<ContactEvent> endEvents;
+    std::vector<uint64_t> endedKeys;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "raylib.h"
+#include "bodystore.h"
+#include "broadphase.h"
+#include "narrowphase.h"
+#include "simd.h"
+#include <vector>
+
+class JobSystem;
+
+// Contacts between halfspaces and everything else, kept out of the broadphase altogether.
+// Halfspaces have no box worth sorting, so pairing them there made every plane another
+// candidate pair for every body. Here the planes get gathered into one flat list and each
+// awake circle and block is tested against all of them, 4 (SSE) or 8 (AVX2) bodies per
+// instruction, so an arena of many angled planes costs bodies * planes and nothing more.
+// A block reaches |n.x| * halfExtents.x + |n.y| * halfExtents.y towards a plane, a circle its radius,
+// so both go through the same kernel. Contacts come out ordered like the narrowphase's
+// (a is the lower index, normal from a to b) and in body order whatever the thread count.
+// Contacts get appended, stats get added to
+class PlanePass
+{
+public:
+    void findContacts(const BodyStore& bodies, std::vector<Contact>& contacts, BroadphaseStats& stats,
+        JobSystem* jobs = nullptr, SimdLevel level = BestSimdLevel());
+
+    // Every halfspace's point and normal, copied out of the store at the start of each call
+    struct PlaneList
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> normalX;
+        std::vector<float> normalY;
+        std::vector<int> body;
+    };
+
+private:
+    struct ChunkResult
+    {
+        std::vector<Contact> contacts;
+        int bodiesTested = 0;
+    };
+
+    PlaneList planes;
+    std::vector<ChunkResult> chunks;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "raylib.h"
+
+class Profiler;
+
+// Panel with a rolling graph of every zone's milliseconds per frame over the whole frame time,
+// each zone's average, and a button that captures a few seconds of zones and writes them to
+// tracePath as a Chrome trace. Game only, it draws with raylib and raygui
+void DrawProfileOverlay(Profiler& profiler, Rectangle bounds, const char* tracePath);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+
+// Build with PROFILING=0 and every PROFILE_ZONE disappears
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+// One timed zone as it comes out of the ring buffer. Times are nanoseconds from when the program started
+struct ProfileEvent
+{
+    const char* name; // the literal handed to PROFILE_ZONE, so the pointer itself tells zones apart
+    long long start;
+    long long end;
+    int thread; // small number per thread, 0 for whichever thread recorded first
+};
+
+// Off until something turns it on, so the headless runner and benches don't pay for reading the
+// clock twice per zone. Zones started while it's off record nothing. Set it before anything starts stepping
+extern bool profilingEnabled;
+
+// Nanoseconds from when the program started
+long long ProfileNow();
+
+// Pushes a finished zone into the ring buffer. Any thread can call it at any time, it never locks
+// or allocates. If nobody drains the buffer the oldest zones get overwritten
+void ProfileRecord(const char* name, long long start, long long end);
+
+// Times the scope it lives in
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* zoneName) : name(zoneName), start(profilingEnabled ? ProfileNow() : -1) {}
+    ~ProfileZone() { if (start >= 0) ProfileRecord(name, start, ProfileNow()); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    long long start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILING
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+// Drains the ring buffer once a frame and keeps what the overlay and trace export need:
+// milliseconds per zone for the last historyLength frames, and while capturing, every zone as recorded.
+// A zone that ran several times in a frame (one per physics step) gets added up. Only one
+// Profiler should drain, and only from one thread
+class Profiler
+{
+public:
+    static const int historyLength = 240;
+
+    // Call once at the end of every frame
+    void endFrame();
+
+    int getZoneCount() const { return (int)zones.size(); }
+    const char* getZoneName(int zone) const { return zones[zone].name; }
+
+    // Milliseconds for a frame framesAgo back, 0 is the frame endFrame last closed
+    float getZoneTime(int zone, int framesAgo) const;
+    float getAverageZoneTime(int zone) const;
+    float getFrameTime(int framesAgo) const;
+
+    // Zones that got overwritten before endFrame got to them
+    long long getDroppedCount() const { return dropped; }
+
+    // Keeps every zone from now on until stopped, the first maxEvents of them
+    void startCapture(int maxEvents = 1 << 20);
+    void stopCapture() { capturing = false; }
+    bool isCapturing() const { return capturing; }
+    int getCapturedCount() const { return (int)captured.size(); }
+
+    // Chrome's trace event format, open it in chrome://tracing or Perfetto. False if it can't write the file
+    bool writeChromeTrace(const char* path) const;
+
+private:
+    struct Zone
+    {
+        const char* name;
+        float history[historyLength] = {};
+    };
+
+    int findZone(const char* name);
+
+    std::vector<Zone> zones;
+    float frameHistory[historyLength] = {};
+    int head = 0; // where endFrame writes next
+    int framesRecorded = 0;
+    long long frameStart = -1;
+    long long readIndex = 0;
+    long long dropped = 0;
+
+    std::vector<ProfileEvent> captured;
+    int captureLimit = 0;
+    bool capturing = false;
+};
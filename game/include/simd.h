@@ -0,0 +1,41 @@
+#pragma once
+
+// SSE2 is always there on x64, AVX2 gets checked at runtime. Anything else runs the scalar paths
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_AVX2_TARGET
+#else
+#define SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#else
+#define SIMD_X64 0
+#endif
+
+enum SimdLevel
+{
+    SIMD_SCALAR,
+    SIMD_SSE,
+    SIMD_AVX2
+};
+
+// Fastest level this CPU can run, checked once
+SimdLevel BestSimdLevel();
+bool SimdLevelSupported(SimdLevel level);
+const char* SimdLevelName(SimdLevel level);
+
+#if SIMD_X64
+// Index of the lowest set bit, for walking movemask results. mask can't be 0
+inline int LowestSetBit(unsigned int mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
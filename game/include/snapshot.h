@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// A whole world as one flat block of bytes. Everything in the world is already arrays of plain
+// structs (bodies, shapes, tree nodes, manifolds), so saving is a memcpy per array with its count
+// in front, and restoring is the same the other way. The buffer keeps its memory between saves
+struct WorldSnapshot
+{
+    std::vector<unsigned char> data;
+};
+
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(std::vector<unsigned char>& data) : data(data) {}
+    ~SnapshotWriter() { data.resize(used); }
+
+    template <typename T>
+    void value(const T& item)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots are raw bytes");
+        append(&item, sizeof(T));
+    }
+
+    template <typename T>
+    void array(const std::vector<T>& items)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots are raw bytes");
+        value((uint32_t)items.size());
+        append(items.data(), items.size() * sizeof(T));
+    }
+
+private:
+    // Writes over whatever the last save left in the buffer, so saving the same world again
+    // never has to grow (and zero) it
+    void append(const void* bytes, size_t size)
+    {
+        if (used + size > data.size()) data.resize(used + size);
+        if (size > 0) memcpy(data.data() + used, bytes, size);
+        used += size;
+    }
+
+    std::vector<unsigned char>& data;
+    size_t used = 0;
+};
+
+// Has to read things back in exactly the order the writer wrote them. A buffer that runs out
+// early fails the reader rather than being read past: everything from then on reads as zeros
+// and empty arrays, and good() says so
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const std::vector<unsigned char>& data) : cursor(data.data()), end(data.data() + data.size()) {}
+
+    template <typename T>
+    void value(T& item)
+    {
+        read(&item, sizeof(T));
+    }
+
+    template <typename T>
+    void array(std::vector<T>& items)
+    {
+        uint32_t count = 0;
+        value(count);
+
+        // Checked before resizing so a garbage count can't ask for gigabytes
+        if (!failed && count > remaining() / sizeof(T)) failed = true;
+        if (failed)
+        {
+            items.clear();
+            return;
+        }
+
+        items.resize(count);
+        read(items.data(), count * sizeof(T));
+    }
+
+    bool good() const { return !failed; }
+    bool finished() const { return !failed && cursor == end; }
+
+private:
+    size_t remaining() const { return (size_t)(end - cursor); }
+
+    void read(void* bytes, size_t size)
+    {
+        if (!failed && size > remaining()) failed = true;
+        if (failed)
+        {
+            if (size > 0) memset(bytes, 0, size);
+            return;
+        }
+
+        if (size > 0) memcpy(bytes, cursor, size);
+        cursor += size;
+    }
+
+    const unsigned char* cursor;
+    const unsigned char* end;
+    bool failed = false;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "raylib.h"
+#include "narrowphase.h"
+#include "islands.h"
+#include <vector>
+
+struct BodyStore;
+class JobSystem;
+class SnapshotReader;
+class SnapshotWriter;
+
+// Everything the solver keeps about one touching pair. Bodies don't rotate so every
+// point on a shared face pushes the same way, one point per pair is the whole manifold.
+// The accumulated impulses carry over to the next frame for warm starting
+struct ContactManifold
+{
+    int a;
+    int b;
+    Vector2 normal; // a to b
+    Vector2 point;
+    float penetration;
+    bool asleep = false; // both bodies asleep (or static), kept from when they fell asleep and not solved
+
+    float normalImpulse = 0; // accumulated, never negative
+    float tangentImpulse = 0; // accumulated, within +-friction * normalImpulse
+
+    // Filled in each frame before solving
+    float normalMass = 0;
+    float friction = 0;
+    float velocityBias = 0; // separating speed restitution asks for
+    float positionImpulse = 0;
+};
+
+// Sequential impulses (Catto's Box2D style): each contact is a non-penetration constraint
+// plus Coulomb friction, solved over and over so stacks settle as a whole instead of pair by pair.
+// Velocities get fixed first, penetration gets pushed out separately afterwards (split impulses)
+// so resolving overlap never adds bounce
+class ContactSolver
+{
+public:
+    int velocityIterations = 8;
+    int positionIterations = 3;
+    bool warmStarting = true;
+
+    float restitutionThreshold = 30.0f; // closing speeds under this don't bounce, keeps resting bodies still
+    float linearSlop = 0.5f; // penetration left alone so contacts persist frame to frame
+    float positionCorrection = 0.2f; // share of the remaining penetration pushed out per frame
+
+    // Solves velocities for this frame's contacts and nudges positions out of overlap.
+    // Manifolds between sleeping bodies get carried over untouched so islands stay connected
+    // while asleep and wake up warm started. Islands share no moving bodies, so each one gets
+    // solved on its own and they run in parallel on jobs when given one, with the same result
+    // as solving them one after another. Run before integrating
+    void solve(BodyStore& bodies, const std::vector<Contact>& contacts, float dt, JobSystem* jobs = nullptr);
+
+    // Keeps the cached manifolds lined up with BodyStore::remove, which moved the body at
+    // movedFrom into body's index
+    void removeBody(int body, int movedFrom);
+    void clear();
+
+    // Cached manifolds and their impulses, so a restored world warm starts the same way
+    void save(SnapshotWriter& writer) const;
+    void restore(SnapshotReader& reader);
+
+    // Sorted by (a, b) unless bodies were removed since the last solve, impulses are what was applied last solve
+    const std::vector<ContactManifold>& getManifolds() const { return manifolds; }
+
+private:
+    // Each of these works on islandOrder[first] up to islandOrder[last], one island
+    void solveIsland(BodyStore& bodies, int first, int last, float dt);
+    void warmStart(BodyStore& bodies, int first, int last);
+    void solveVelocities(BodyStore& bodies, int first, int last);
+    void solvePositions(BodyStore& bodies, int first, int last, float dt);
+
+    std::vector<ContactManifold> manifolds;
+    std::vector<ContactManifold> previous;
+    bool manifoldsUnsorted = false; // removeBody renamed pairs since the last solve
+    std::vector<Vector2> pseudoVelocity; // per body, only ever moves positions
+
+    IslandGraph graph;
+    std::vector<int> islandOrder; // manifold indices grouped by island
+    std::vector<int> islandStarts;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+class PhysicsWorld;
+
+// Where a launched circle first touches something
+struct TrajectoryHit
+{
+    int body = -1; // -1 if it's still flying at maxTime
+    Vector2 position = { 0, 0 }; // circle's center when it touches
+    Vector2 point = { 0, 0 }; // on the surface of what it hit
+    Vector2 normal = { 0, 0 }; // out of what it hit, towards the circle
+    float time = -1; // seconds after launch
+};
+
+// Marches the launch the way the integrator moves a body (position by velocity, then velocity by
+// gravity, one dt at a time) and casts the circle along every step against the world as it is now,
+// so the arc drawn is the arc flown as long as nothing moves in the way first.
+// Stops early once the circle is below the world's killY.
+// path gets every step's position when given, ending at the impact
+TrajectoryHit PredictTrajectory(const PhysicsWorld& world, Vector2 start, Vector2 velocity, float radius, float dt, float maxTime,
+    std::vector<Vector2>* path = nullptr);
+
+// Launch angle in degrees (up from +x, like the game's slider) and speed
+struct AimSolution
+{
+    float angle;
+    float speed;
+    float time; // until it hits the target
+};
+
+// Every launch that hits target first, over speedSamples speeds from minSpeed to maxSpeed.
+// Each speed has up to two arcs through the target's center (the low one and the lob), worked out
+// in closed form for gravity straight down. Both get checked with PredictTrajectory and only the
+// ones that reach the target before anything else are kept, slowest first
+void SolveAim(const PhysicsWorld& world, Vector2 start, float radius, int target, float minSpeed, float maxSpeed, int speedSamples,
+    float dt, float maxTime, std::vector<AimSolution>& solutions);
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "raylib.h"
+#include "aabbtree.h"
+#include "bodystore.h"
+#include "broadphase.h"
+#include "ccd.h"
+#include "islands.h"
+#include "narrowphase.h"
+#include "paircache.h"
+#include "planes.h"
+#include "snapshot.h"
+#include "solver.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class DebugDraw;
+class JobSystem;
+
+// Everything the simulation needs and nothing to do with drawing or input, so the same world
+// backs the game and the headless runner. Nothing in here calls into raylib beyond its
+// math headers, no window or GL context needed.
+// Bodies get added through the world rather than the store so the broadphase hears about them
+class PhysicsWorld
+{
+public:
+    BodyStore bodies;
+    Vector2 gravity = { 0, 100 };
+    BroadphaseMode broadphaseMode = BROADPHASE_SWEEP_AND_PRUNE;
+    ContactSolver solver;
+    Islands islands;
+
+    JobSystem* jobs = nullptr; // steps run on this thread without one
+    float killY = INFINITY; // moving bodies that fall below this get removed at the end of a step
+    DebugDraw* debugDraw = nullptr; // cleared and refilled every step when set
+
+    // Lockstep: pins the float environment before every step and hashes the world after it,
+    // so two runs fed the same inputs on the same steps can be checked step by step
+    bool deterministic = false;
+
+    // Broadphase, narrowphase, solve, contact events, sleep, integrate, sweep bullets back to their first impact,
+    // then remove whatever fell out of the world
+    void step(float dt);
+
+    float bulletOverlap = 0.25f; // a bullet stops this far into what it hit, so the next step has a contact to solve
+
+    int addCircle(Vector2 pos, float radius, float mass);
+    int addBlock(Vector2 pos, Vector2 halfExtents, float mass);
+    int addHalfspace(Vector2 pos, float rotationDegrees);
+    void removeBody(int body); // O(1), the last body takes its index
+    void clear();
+
+    // Topmost (highest index) body under the point, or -1
+    int pickBody(Vector2 point) const;
+
+    // First body hit along origin + direction * t for t in [0, 1], or -1
+    int raycast(Vector2 origin, Vector2 direction, Vector2* hitPoint) const;
+
+    // First body a circle moving from start by motion would touch, or -1, with hit filled in.
+    // Everything else stands still where it is now. Bodies the circle already overlaps at the start
+    // get ignored, same as for bullets. Uses the trees from the last step, so bodies added since aren't seen
+    int circleCast(Vector2 start, Vector2 motion, float radius, TimeOfImpact* hit) const;
+
+    // Copies the whole simulation (bodies, handles, both trees, cached contacts and pairs, gravity, step
+    // count and hashes) into the snapshot's buffer. Restoring puts it back exactly, stepping a
+    // restored world gives the same results bit for bit as stepping the original did.
+    // A snapshot that's cut short or has bytes left over gets refused: false, and the world is left empty
+    void saveSnapshot(WorldSnapshot& snapshot) const;
+    bool restoreSnapshot(const WorldSnapshot& snapshot);
+
+    // Everything that carries over into the next step: bodies' positions, velocities and sleep
+    // state, halfspace normals and the solver's cached impulses
+    uint64_t hashState() const;
+
+    // Only kept up to date while deterministic is on
+    uint64_t getStepHash() const { return stepHash; } // hashState() after the last step
+    uint64_t getRollingHash() const { return rollingHash; } // every step hash so far folded together
+
+    int getStepCount() const { return stepCount; } // since the world was made or cleared
+
+    // From the last step
+    const BroadphaseStats& getStats() const { return stats; }
+    int getCandidatePairCount() const { return (int)candidatePairs.size(); } // broadphase pairs handed to the narrowphase
+    const std::vector<Contact>& getContacts() const { return contacts; }
+
+    // Touching pairs by body handle, with the begin, persist and end events from the last step
+    const PairCache& getPairCache() const { return pairCache; }
+
+private:
+    DynamicAABBTree& treeFor(int body);
+    void removeProxy(int body);
+    void syncTrees();
+    void findTreePairs(std::vector<BroadphasePair>& pairs);
+    void findPairs();
+    void wakeTouchedIslands();
+    void sweepBullets();
+    void removeFallenBodies();
+
+    // Debug primitives for the step in progress, each one returns straight away if its category is off
+    void recordBounds();
+    void recordContacts();
+    void recordContactForces(float dt);
+    void recordForces();
+
+    bool pointInBody(int body, Vector2 point) const;
+    float raycastBody(int body, Vector2 origin, Vector2 direction, float maxFraction) const;
+    TimeOfImpact circleTOI(int body, Vector2 start, Vector2 motion, float radius, Vector2 otherStart, Vector2 otherMotion) const;
+
+    UniformGrid grid;
+    SweepAndPrune sweepAndPrune;
+    // Static and moving bodies live in separate trees so static bodies never get tested against each other.
+    // Both are kept up to date every step whatever the broadphase mode, picking and raycasts query them too
+    DynamicAABBTree staticTree;
+    DynamicAABBTree dynamicTree;
+    std::vector<int> unboundedBodies; // halfspaces, in neither tree. Bullets still sweep against them
+    std::vector<AABB> bodyBounds; // indexed the same as bodies
+    std::vector<std::vector<BroadphasePair>> treeChunkPairs;
+    std::vector<BroadphasePair> candidatePairs;
+    BroadphaseStats stats;
+
+    NarrowPhase narrowphase;
+    PlanePass planePass;
+    std::vector<Contact> contacts;
+    PairCache pairCache;
+    std::vector<int> bodiesToWake; // asleep but overlapping something awake this step
+    std::vector<int> sweepCandidates;
+
+    int stepCount = 0;
+    uint64_t stepHash = 0;
+    uint64_t rollingHash = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "raylib.h"
+#include "bodystore.h"
+#include "broadphase.h"
+#include "snapshot.h"
+#include "world.h"
+#include <vector>
+
+class JobSystem;
+
+// One what-if launch, the same thing the game's sliders and space bar do
+struct LaunchParameters
+{
+    float angle = 50.0f; // degrees up from the +x axis
+    float speed = 0.0f;
+    float circleMass = 1.0f;
+    Vector2 position = { 200.0f, 700.0f };
+    float radius = 30.0f;
+    bool bullet = true;
+};
+
+// What one launch did to the scene
+struct LaunchOutcome
+{
+    int blocksToppled = 0; // moving blocks that ended up further than toppleDistance from where they started, or left the world
+    float settleTime = -1; // seconds until every moving body was asleep or gone, -1 if still moving when the run stopped
+    float impactEnergy = 0; // launched circle's kinetic energy going into the step it first touched a block, 0 for a miss
+    int steps = 0; // stepped before settling or running out of steps
+};
+
+// Lots of independent copies of one template world, each with its own launch, stepped together for
+// parameter sweeps. Every world starts by restoring a snapshot of the template, so setting a batch up
+// is a memcpy per world and reusing the batch for the next sweep allocates nothing.
+// Worlds are spread over the job system a few at a time and each one steps on a single thread,
+// so the cores stay busy with whole worlds instead of splitting tiny ones up. All worlds advance
+// one step per pass (lockstep) and drop out once they settle. Each world is stepped exactly like
+// a lone PhysicsWorld would be, so an outcome is the same whichever batch or thread it ran in
+class WorldBatch
+{
+public:
+    float toppleDistance = 10.0f;
+    AABB arena = { { -INFINITY, -INFINITY }, { INFINITY, INFINITY } }; // moving bodies leaving this are removed, like killY
+
+    // Drops any previous worlds and makes one copy of templateWorld per launch. The template's
+    // settings (gravity, broadphase, solver and sleep tuning, killY) carry over, its job system doesn't
+    void reset(const PhysicsWorld& templateWorld, const std::vector<LaunchParameters>& launches);
+
+    // Steps every unsettled world until they've all settled or maxSteps have gone by
+    void run(int maxSteps, float dt, JobSystem* jobs = nullptr);
+
+    int getWorldCount() const { return (int)runs.size(); }
+    const PhysicsWorld& getWorld(int index) const { return runs[index].world; }
+    const LaunchOutcome& getOutcome(int index) const { return runs[index].outcome; }
+
+    // Over the last run
+    long long getWorldSteps() const { return worldSteps; }
+    double getSeconds() const { return seconds; }
+    double getWorldStepsPerSecond() const { return seconds > 0 ? worldSteps / seconds : 0; }
+
+private:
+    struct WorldRun
+    {
+        PhysicsWorld world;
+        LaunchOutcome outcome;
+        BodyHandle launched;
+        bool settled = false;
+    };
+
+    void stepWorld(WorldRun& run, float dt);
+    void finishWorld(WorldRun& run);
+
+    std::vector<WorldRun> runs;
+    WorldSnapshot templateSnapshot;
+
+    // Moving blocks in the template and where they started. Handles come back the same
+    // from the snapshot, so one list covers every world
+    std::vector<BodyHandle> towerBlocks;
+    std::vector<Vector2> towerStarts;
+
+    long long worldSteps = 0;
+    double seconds = 0;
+};
@@ -0,0 +1,306 @@
+#include "aabbtree.h"
+#include "raymath.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+static AABB combine(const AABB& a, const AABB& b)
+{
+    return { { fminf(a.min.x, b.min.x), fminf(a.min.y, b.min.y) }, { fmaxf(a.max.x, b.max.x), fmaxf(a.max.y, b.max.y) } };
+}
+
+static bool contains(const AABB& outer, const AABB& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+           inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+// Used as the insertion cost, cheaper to compute than area and works for flat boxes
+static float perimeter(const AABB& box)
+{
+    return 2.0f * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
+
+bool RaycastAABB(Vector2 origin, Vector2 direction, float maxFraction, const AABB& box, float* tHit)
+{
+    float tMin = 0.0f;
+    float tMax = maxFraction;
+
+    float o[2] = { origin.x, origin.y };
+    float d[2] = { direction.x, direction.y };
+    float lo[2] = { box.min.x, box.min.y };
+    float hi[2] = { box.max.x, box.max.y };
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (fabsf(d[axis]) < 1.0e-8f)
+        {
+            // Parallel to this slab, must start inside it
+            if (o[axis] < lo[axis] || o[axis] > hi[axis]) return false;
+        }
+        else
+        {
+            float inv = 1.0f / d[axis];
+            float t1 = (lo[axis] - o[axis]) * inv;
+            float t2 = (hi[axis] - o[axis]) * inv;
+            if (t1 > t2) std::swap(t1, t2);
+
+            tMin = fmaxf(tMin, t1);
+            tMax = fminf(tMax, t2);
+            if (tMin > tMax) return false;
+        }
+    }
+
+    *tHit = tMin;
+    return true;
+}
+
+int DynamicAABBTree::allocateNode()
+{
+    if (freeList == nullNode)
+    {
+        nodes.push_back({});
+        freeList = (int)nodes.size() - 1;
+        nodes[freeList].parent = nullNode;
+    }
+
+    int nodeId = freeList;
+    freeList = nodes[nodeId].parent;
+
+    TreeNode& node = nodes[nodeId];
+    node.parent = nullNode;
+    node.child1 = nullNode;
+    node.child2 = nullNode;
+    node.height = 0;
+    node.userData = -1;
+    return nodeId;
+}
+
+void DynamicAABBTree::freeNode(int nodeId)
+{
+    nodes[nodeId].parent = freeList;
+    nodes[nodeId].height = -1;
+    freeList = nodeId;
+}
+
+int DynamicAABBTree::createProxy(const AABB& box, int userData)
+{
+    int proxyId = allocateNode();
+
+    Vector2 margin = { fatMargin, fatMargin };
+    nodes[proxyId].box = { box.min - margin, box.max + margin };
+    nodes[proxyId].userData = userData;
+
+    insertLeaf(proxyId);
+    proxyCount++;
+    return proxyId;
+}
+
+void DynamicAABBTree::destroyProxy(int proxyId)
+{
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+    proxyCount--;
+}
+
+bool DynamicAABBTree::moveProxy(int proxyId, const AABB& box)
+{
+    if (contains(nodes[proxyId].box, box)) return false;
+
+    removeLeaf(proxyId);
+
+    Vector2 margin = { fatMargin, fatMargin };
+    nodes[proxyId].box = { box.min - margin, box.max + margin };
+
+    insertLeaf(proxyId);
+    return true;
+}
+
+void DynamicAABBTree::insertLeaf(int leaf)
+{
+    if (root == nullNode)
+    {
+        root = leaf;
+        nodes[root].parent = nullNode;
+        return;
+    }
+
+    // Walk down picking whichever child grows the least by taking the new leaf
+    AABB leafBox = nodes[leaf].box;
+    int index = root;
+
+    while (!nodes[index].isLeaf())
+    {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = perimeter(nodes[index].box);
+        float combinedArea = perimeter(combine(nodes[index].box, leafBox));
+
+        // Cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float cost1 = perimeter(combine(leafBox, nodes[child1].box));
+        if (!nodes[child1].isLeaf()) cost1 -= perimeter(nodes[child1].box);
+        cost1 += inheritanceCost;
+
+        float cost2 = perimeter(combine(leafBox, nodes[child2].box));
+        if (!nodes[child2].isLeaf()) cost2 -= perimeter(nodes[child2].box);
+        cost2 += inheritanceCost;
+
+        if (cost < cost1 && cost < cost2) break;
+
+        index = (cost1 < cost2) ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    // Splice a new parent in above the sibling
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != nullNode)
+    {
+        if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+        else nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        root = newParent;
+    }
+
+    refit(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = nullNode;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    // The parent goes away and the sibling takes its place
+    if (grandParent != nullNode)
+    {
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else nodes[grandParent].child2 = sibling;
+
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        refit(grandParent);
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = nullNode;
+        freeNode(parent);
+    }
+}
+
+// Walks back up to the root fixing boxes and heights and rebalancing on the way
+void DynamicAABBTree::refit(int nodeId)
+{
+    int index = nodeId;
+
+    while (index != nullNode)
+    {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].box = combine(nodes[child1].box, nodes[child2].box);
+
+        index = nodes[index].parent;
+    }
+}
+
+// If one side of nodeId is more than one level taller, rotate it up.
+// Returns the node now sitting where nodeId was
+int DynamicAABBTree::balance(int nodeId)
+{
+    int A = nodeId;
+    if (nodes[A].isLeaf() || nodes[A].height < 2) return A;
+
+    int B = nodes[A].child1;
+    int C = nodes[A].child2;
+
+    int heightDifference = nodes[C].height - nodes[B].height;
+
+    if (heightDifference > 1 || heightDifference < -1)
+    {
+        // Work with the taller child as "up" and the other as "stay"
+        int up = (heightDifference > 1) ? C : B;
+        int stay = (heightDifference > 1) ? B : C;
+
+        int F = nodes[up].child1;
+        int G = nodes[up].child2;
+
+        // Swap A and up
+        nodes[up].child1 = A;
+        nodes[up].parent = nodes[A].parent;
+        nodes[A].parent = up;
+
+        if (nodes[up].parent != nullNode)
+        {
+            if (nodes[nodes[up].parent].child1 == A) nodes[nodes[up].parent].child1 = up;
+            else nodes[nodes[up].parent].child2 = up;
+        }
+        else
+        {
+            root = up;
+        }
+
+        // The taller grandchild stays with up, the shorter one moves to A
+        int keep = (nodes[F].height > nodes[G].height) ? F : G;
+        int give = (keep == F) ? G : F;
+
+        nodes[up].child2 = keep;
+        nodes[A].child1 = stay;
+        nodes[A].child2 = give;
+        nodes[give].parent = A;
+
+        nodes[A].box = combine(nodes[stay].box, nodes[give].box);
+        nodes[A].height = 1 + std::max(nodes[stay].height, nodes[give].height);
+
+        nodes[up].box = combine(nodes[A].box, nodes[keep].box);
+        nodes[up].height = 1 + std::max(nodes[A].height, nodes[keep].height);
+
+        return up;
+    }
+
+    return A;
+}
+
+void DynamicAABBTree::save(SnapshotWriter& writer) const
+{
+    writer.array(nodes);
+    writer.value(root);
+    writer.value(freeList);
+    writer.value(proxyCount);
+}
+
+void DynamicAABBTree::restore(SnapshotReader& reader)
+{
+    reader.array(nodes);
+    reader.value(root);
+    reader.value(freeList);
+    reader.value(proxyCount);
+}
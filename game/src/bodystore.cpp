@@ -0,0 +1,300 @@
+#include "bodystore.h"
+#include "raymath.h"
+#include "snapshot.h"
+#include <cmath>
+
+// Last element into i's place, O(1) but doesn't keep the order
+template <typename T>
+static void swapRemove(std::vector<T>& values, int i)
+{
+    values[i] = values.back();
+    values.pop_back();
+}
+
+int BodyStore::addBody(PhysicsShape bodyShape, int bodyShapeIndex, Vector2 pos, float bodyMass)
+{
+    position.push_back(pos);
+    previousPosition.push_back(pos);
+    velocity.push_back({ 0, 0 });
+    force.push_back({ 0, 0 });
+    mass.push_back(bodyMass);
+    invMass.push_back(bodyMass > 0.0f ? 1.0f / bodyMass : 0.0f);
+    material.push_back({});
+    shape.push_back(bodyShape);
+    shapeIndex.push_back(bodyShapeIndex);
+    proxyId.push_back(-1);
+    color.push_back(GREEN);
+    asleep.push_back(0);
+    sleepTime.push_back(0);
+    bullet.push_back(0);
+
+    int body = size() - 1;
+    int slot = firstFreeSlot;
+
+    if (slot >= 0)
+    {
+        firstFreeSlot = slots[slot].body;
+        slots[slot].body = body;
+    }
+    else
+    {
+        slot = (int)slots.size();
+        slots.push_back({ body, 0 });
+    }
+
+    handleSlot.push_back(slot);
+    return body;
+}
+
+int BodyStore::addCircle(Vector2 pos, float radius, float bodyMass)
+{
+    int body = addBody(CIRCLE, (int)circles.size(), pos, bodyMass);
+    circles.push_back({ radius });
+    circleOwner.push_back(body);
+    return body;
+}
+
+int BodyStore::addBlock(Vector2 pos, Vector2 halfExtents, float bodyMass)
+{
+    int body = addBody(BLOCK, (int)blocks.size(), pos, bodyMass);
+    blocks.push_back({ halfExtents });
+    blockOwner.push_back(body);
+    color[body] = BROWN;
+    return body;
+}
+
+// Halfspaces never move
+int BodyStore::addHalfspace(Vector2 pos, float rotationDegrees)
+{
+    int body = addBody(HALF_SPACE, (int)halfspaces.size(), pos, 1.0f);
+    halfspaces.push_back({ { 0, -1 }, 0 });
+    halfspaceOwner.push_back(body);
+    setStatic(body, true);
+    setRotationDegrees(body, rotationDegrees);
+    return body;
+}
+
+// Same swap for the shape arrays, the shape that moved gets its body pointed at its new index
+void BodyStore::removeShape(PhysicsShape removedShape, int removedShapeIndex)
+{
+    std::vector<int>* owners = nullptr;
+
+    switch (removedShape)
+    {
+    case CIRCLE: swapRemove(circles, removedShapeIndex); owners = &circleOwner; break;
+    case BLOCK: swapRemove(blocks, removedShapeIndex); owners = &blockOwner; break;
+    case HALF_SPACE: swapRemove(halfspaces, removedShapeIndex); owners = &halfspaceOwner; break;
+    }
+
+    swapRemove(*owners, removedShapeIndex);
+    if (removedShapeIndex < owners->size()) shapeIndex[(*owners)[removedShapeIndex]] = removedShapeIndex;
+}
+
+// O(1): the last body moves into the removed body's index
+void BodyStore::remove(int body)
+{
+    removeShape(shape[body], shapeIndex[body]);
+
+    // Free the handle slot, bumping the generation makes every handle to it stale
+    int slot = handleSlot[body];
+    slots[slot].generation++;
+    slots[slot].body = firstFreeSlot;
+    firstFreeSlot = slot;
+
+    swapRemove(position, body);
+    swapRemove(previousPosition, body);
+    swapRemove(velocity, body);
+    swapRemove(force, body);
+    swapRemove(mass, body);
+    swapRemove(invMass, body);
+    swapRemove(material, body);
+    swapRemove(shape, body);
+    swapRemove(shapeIndex, body);
+    swapRemove(proxyId, body);
+    swapRemove(color, body);
+    swapRemove(asleep, body);
+    swapRemove(sleepTime, body);
+    swapRemove(bullet, body);
+    swapRemove(handleSlot, body);
+
+    if (body == size()) return; // was already last
+
+    // Whatever was last now lives at body
+    switch (shape[body])
+    {
+    case CIRCLE: circleOwner[shapeIndex[body]] = body; break;
+    case BLOCK: blockOwner[shapeIndex[body]] = body; break;
+    case HALF_SPACE: halfspaceOwner[shapeIndex[body]] = body; break;
+    }
+
+    slots[handleSlot[body]].body = body;
+}
+
+// Drops every body but keeps the handle table, so handles from before stay stale instead of
+// matching whatever gets added next
+void BodyStore::clear()
+{
+    while (size() > 0)
+    {
+        remove(size() - 1);
+    }
+}
+
+void BodyStore::save(SnapshotWriter& writer) const
+{
+    writer.array(position);
+    writer.array(previousPosition);
+    writer.array(velocity);
+    writer.array(force);
+    writer.array(mass);
+    writer.array(invMass);
+    writer.array(material);
+    writer.array(shape);
+    writer.array(shapeIndex);
+    writer.array(proxyId);
+    writer.array(color);
+    writer.array(asleep);
+    writer.array(sleepTime);
+    writer.array(bullet);
+    writer.array(handleSlot);
+
+    writer.array(circles);
+    writer.array(circleOwner);
+    writer.array(blocks);
+    writer.array(blockOwner);
+    writer.array(halfspaces);
+    writer.array(halfspaceOwner);
+
+    writer.array(slots);
+    writer.value(firstFreeSlot);
+}
+
+void BodyStore::restore(SnapshotReader& reader)
+{
+    reader.array(position);
+    reader.array(previousPosition);
+    reader.array(velocity);
+    reader.array(force);
+    reader.array(mass);
+    reader.array(invMass);
+    reader.array(material);
+    reader.array(shape);
+    reader.array(shapeIndex);
+    reader.array(proxyId);
+    reader.array(color);
+    reader.array(asleep);
+    reader.array(sleepTime);
+    reader.array(bullet);
+    reader.array(handleSlot);
+
+    reader.array(circles);
+    reader.array(circleOwner);
+    reader.array(blocks);
+    reader.array(blockOwner);
+    reader.array(halfspaces);
+    reader.array(halfspaceOwner);
+
+    reader.array(slots);
+    reader.value(firstFreeSlot);
+}
+
+int BodyStore::indexOf(BodyHandle handle) const
+{
+    if (handle.slot < 0 || handle.slot >= slots.size()) return -1;
+    if (slots[handle.slot].generation != handle.generation) return -1;
+    return slots[handle.slot].body;
+}
+
+void BodyStore::setStatic(int body, bool makeStatic)
+{
+    invMass[body] = (makeStatic || mass[body] <= 0.0f) ? 0.0f : 1.0f / mass[body];
+}
+
+void BodyStore::wake(int body)
+{
+    asleep[body] = 0;
+    sleepTime[body] = 0;
+}
+
+void BodyStore::wakeAll()
+{
+    for (int i = 0; i < size(); i++)
+    {
+        wake(i);
+    }
+}
+
+// Sleeping bodies stay exactly where they are until something wakes them
+void BodyStore::sleep(int body)
+{
+    asleep[body] = 1;
+    velocity[body] = { 0, 0 };
+    force[body] = { 0, 0 };
+}
+
+void BodyStore::applyImpulse(int body, Vector2 impulse)
+{
+    velocity[body] += impulse * invMass[body];
+    wake(body);
+}
+
+Vector2 BodyStore::interpolatedPosition(int body, float alpha) const
+{
+    return Vector2Lerp(previousPosition[body], position[body], alpha);
+}
+
+void BodyStore::setMass(int body, float bodyMass)
+{
+    bool wasStatic = isStatic(body);
+    mass[body] = bodyMass;
+    setStatic(body, wasStatic);
+}
+
+void BodyStore::setRotationDegrees(int body, float rotationDegrees)
+{
+    HalfspaceShape& plane = halfspaces[shapeIndex[body]];
+    plane.rotation = rotationDegrees;
+    plane.normal = Vector2Rotate({ 0, -1 }, rotationDegrees * DEG2RAD);
+}
+
+void BodyStore::computeBounds(std::vector<AABB>& bounds) const
+{
+    bounds.resize(size());
+
+    for (int i = 0; i < circles.size(); i++)
+    {
+        Vector2 p = position[circleOwner[i]];
+        float r = circles[i].radius;
+        bounds[circleOwner[i]] = { { p.x - r, p.y - r }, { p.x + r, p.y + r } };
+    }
+
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        Vector2 p = position[blockOwner[i]];
+        bounds[blockOwner[i]] = { p - blocks[i].halfExtents, p + blocks[i].halfExtents };
+    }
+
+    // Halfspaces go on forever, they stay out of the broadphase and go through the plane pass
+    for (int i = 0; i < halfspaces.size(); i++)
+    {
+        bounds[halfspaceOwner[i]] = EmptyAABB();
+    }
+}
+
+AABB BodyStore::getAABB(int body) const
+{
+    Vector2 p = position[body];
+
+    switch (shape[body])
+    {
+    case CIRCLE:
+    {
+        float r = circles[shapeIndex[body]].radius;
+        return { { p.x - r, p.y - r }, { p.x + r, p.y + r } };
+    }
+    case BLOCK:
+        return { p - blocks[shapeIndex[body]].halfExtents, p + blocks[shapeIndex[body]].halfExtents };
+    default:
+        return EmptyAABB();
+    }
+}
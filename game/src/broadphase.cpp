@@ -0,0 +1,243 @@
+#include "broadphase.h"
+#include "jobs.h"
+#include <algorithm>
+#include <cmath>
+
+static int cellCoord(float value, float cellSize)
+{
+    return (int)floorf(value / cellSize);
+}
+
+static uint64_t cellKey(int x, int y)
+{
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+static bool pairLess(const BroadphasePair& p, const BroadphasePair& q)
+{
+    return p.a < q.a || (p.a == q.a && p.b < q.b);
+}
+
+void SortPairs(std::vector<BroadphasePair>& pairs)
+{
+    std::sort(pairs.begin(), pairs.end(), pairLess);
+}
+
+void BruteForcePairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs)
+{
+    pairs.clear();
+
+    for (int i = 0; i < boxes.size(); i++)
+    {
+        if (AABBIsEmpty(boxes[i])) continue;
+
+        for (int j = i + 1; j < boxes.size(); j++)
+        {
+            if (AABBIsEmpty(boxes[j])) continue;
+
+            pairs.push_back({ i, j });
+        }
+    }
+}
+
+void UniformGrid::findPairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs)
+{
+    pairs.clear();
+    entries.clear();
+    oversized.clear();
+
+    // Far away coordinates would overflow the int cell coords
+    const float maxCoord = 1.0e9f;
+
+    for (int i = 0; i < boxes.size(); i++)
+    {
+        const AABB& box = boxes[i];
+        if (AABBIsEmpty(box)) continue;
+
+        float cellsX = floorf(box.max.x / cellSize) - floorf(box.min.x / cellSize) + 1;
+        float cellsY = floorf(box.max.y / cellSize) - floorf(box.min.y / cellSize) + 1;
+
+        // Written so NaN and infinity both land in the oversized list
+        bool fits = cellsX * cellsY <= maxCellsPerBox &&
+            fabsf(box.min.x / cellSize) < maxCoord && fabsf(box.min.y / cellSize) < maxCoord;
+
+        if (!fits)
+        {
+            oversized.push_back(i);
+            continue;
+        }
+
+        int x0 = cellCoord(box.min.x, cellSize);
+        int x1 = cellCoord(box.max.x, cellSize);
+        int y0 = cellCoord(box.min.y, cellSize);
+        int y1 = cellCoord(box.max.y, cellSize);
+
+        for (int x = x0; x <= x1; x++)
+        {
+            for (int y = y0; y <= y1; y++)
+            {
+                entries.push_back({ cellKey(x, y), i });
+            }
+        }
+    }
+
+    // Group entries by cell, keeping body order inside each cell
+    std::sort(entries.begin(), entries.end(), [](const CellEntry& p, const CellEntry& q)
+    {
+        return p.cell < q.cell || (p.cell == q.cell && p.index < q.index);
+    });
+
+    for (int start = 0; start < entries.size();)
+    {
+        int end = start + 1;
+        while (end < entries.size() && entries[end].cell == entries[start].cell) end++;
+
+        for (int i = start; i < end; i++)
+        {
+            for (int j = i + 1; j < end; j++)
+            {
+                const AABB& A = boxes[entries[i].index];
+                const AABB& B = boxes[entries[j].index];
+
+                if (!AABBOverlap(A, B)) continue;
+
+                // Two boxes can share several cells. Only report the pair from the cell
+                // holding the min corner of their intersection so it shows up once
+                float cornerX = fmaxf(A.min.x, B.min.x);
+                float cornerY = fmaxf(A.min.y, B.min.y);
+                if (cellKey(cellCoord(cornerX, cellSize), cellCoord(cornerY, cellSize)) != entries[start].cell) continue;
+
+                pairs.push_back({ entries[i].index, entries[j].index });
+            }
+        }
+
+        start = end;
+    }
+
+    // Oversized boxes are few (the ground) so test them against everything
+    for (int k = 0; k < oversized.size(); k++)
+    {
+        int big = oversized[k];
+
+        for (int other = 0; other < boxes.size(); other++)
+        {
+            if (other == big) continue;
+
+            // Pairs of two oversized boxes are only reported once
+            bool otherOversized = std::find(oversized.begin(), oversized.end(), other) != oversized.end();
+            if (otherOversized && other < big) continue;
+
+            if (!AABBOverlap(boxes[big], boxes[other])) continue;
+
+            pairs.push_back({ std::min(big, other), std::max(big, other) });
+        }
+    }
+
+    SortPairs(pairs);
+}
+
+// Min endpoints sort before max endpoints at the same value so touching boxes still pair up
+static bool endpointLess(float valueA, bool isMinA, float valueB, bool isMinB)
+{
+    return valueA < valueB || (valueA == valueB && isMinA && !isMinB);
+}
+
+void SweepAndPrune::markDirty()
+{
+    dirty = true;
+}
+
+void SweepAndPrune::rebuild(const std::vector<AABB>& boxes)
+{
+    endpoints.clear();
+
+    for (int i = 0; i < boxes.size(); i++)
+    {
+        endpoints.push_back({ boxes[i].min.x, i, true });
+        endpoints.push_back({ boxes[i].max.x, i, false });
+    }
+
+    std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& p, const Endpoint& q)
+    {
+        return endpointLess(p.value, p.isMin, q.value, q.isMin);
+    });
+
+    dirty = false;
+}
+
+void SweepAndPrune::findPairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs, JobSystem* jobs)
+{
+    pairs.clear();
+
+    if (dirty || endpoints.size() != boxes.size() * 2)
+    {
+        rebuild(boxes);
+    }
+    else
+    {
+        // Refresh endpoint values, the order from last frame is almost right
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            const AABB& box = boxes[endpoints[i].index];
+            endpoints[i].value = endpoints[i].isMin ? box.min.x : box.max.x;
+        }
+
+        // Insertion sort
+        for (int i = 1; i < endpoints.size(); i++)
+        {
+            Endpoint key = endpoints[i];
+            int j = i - 1;
+
+            while (j >= 0 && endpointLess(key.value, key.isMin, endpoints[j].value, endpoints[j].isMin))
+            {
+                endpoints[j + 1] = endpoints[j];
+                j--;
+            }
+
+            endpoints[j + 1] = key;
+        }
+    }
+
+    // Sweep: every box that opens while another is still open overlaps it on x.
+    // Only the min endpoints matter for that, packed flat so the scan below streams
+    sweep.clear();
+
+    for (int i = 0; i < endpoints.size(); i++)
+    {
+        if (!endpoints[i].isMin) continue;
+
+        const AABB& box = boxes[endpoints[i].index];
+        if (AABBIsEmpty(box)) continue;
+        sweep.push_back({ box.min.x, box.max.x, box.min.y, box.max.y, endpoints[i].index });
+    }
+
+    const int grainSize = 256;
+    int chunkCount = JobChunkCount((int)sweep.size(), grainSize);
+    if (chunkPairs.size() < chunkCount) chunkPairs.resize(chunkCount);
+
+    ParallelFor(jobs, (int)sweep.size(), grainSize, [&](int begin, int end, int chunk)
+    {
+        std::vector<BroadphasePair>& out = chunkPairs[chunk];
+        out.clear();
+
+        for (int i = begin; i < end; i++)
+        {
+            const SweepBox& box = sweep[i];
+
+            // Min endpoints sort before max endpoints at the same value, hence <=
+            for (int k = i + 1; k < sweep.size() && sweep[k].minX <= box.maxX; k++)
+            {
+                const SweepBox& other = sweep[k];
+
+                if (box.minY <= other.maxY && other.minY <= box.maxY)
+                {
+                    out.push_back({ std::min(box.index, other.index), std::max(box.index, other.index) });
+                }
+            }
+        }
+    });
+
+    AppendChunks(chunkPairs, chunkCount, pairs);
+
+    SortPairs(pairs);
+}
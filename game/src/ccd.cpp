@@ -0,0 +1,96 @@
+#include "ccd.h"
+#include "aabbtree.h"
+#include "raymath.h"
+#include <cmath>
+
+// First t in [0, 1] where |start + motion * t - center| = radius, or -1.
+// start has to be outside the circle
+static float sweepPointCircle(Vector2 start, Vector2 motion, Vector2 center, float radius)
+{
+    Vector2 toStart = start - center;
+    float a = Vector2DotProduct(motion, motion);
+    float b = 2.0f * Vector2DotProduct(motion, toStart);
+    float c = Vector2DotProduct(toStart, toStart) - radius * radius;
+
+    if (a <= 0.0f) return -1;
+
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) return -1;
+
+    float t = (-b - sqrtf(discriminant)) / (2 * a);
+    return (t >= 0 && t <= 1) ? t : -1;
+}
+
+TimeOfImpact CircleCircleTOI(Vector2 start, Vector2 motion, float radius, Vector2 otherStart, Vector2 otherMotion, float otherRadius)
+{
+    TimeOfImpact result;
+
+    float radiusSum = radius + otherRadius;
+    if (Vector2DistanceSqr(start, otherStart) < radiusSum * radiusSum) return result;
+
+    // The other circle stands still and this one sweeps the combined radius past its center
+    Vector2 relativeMotion = motion - otherMotion;
+    float t = sweepPointCircle(start, relativeMotion, otherStart, radiusSum);
+    if (t < 0) return result;
+
+    result.fraction = t;
+    result.normal = Vector2Normalize(start + relativeMotion * t - otherStart);
+    return result;
+}
+
+// The circle's center against the block grown by the radius, with rounded corners
+TimeOfImpact CircleBlockTOI(Vector2 start, Vector2 motion, float radius, Vector2 blockStart, Vector2 blockMotion, Vector2 halfExtents)
+{
+    TimeOfImpact result;
+
+    // Block at the origin from here on
+    Vector2 relativeStart = start - blockStart;
+    Vector2 relativeMotion = motion - blockMotion;
+
+    Vector2 closest = Vector2Clamp(relativeStart, halfExtents * -1.0f, halfExtents);
+    if (Vector2DistanceSqr(relativeStart, closest) < radius * radius) return result;
+
+    Vector2 grown = { halfExtents.x + radius, halfExtents.y + radius };
+    float t;
+    if (!RaycastAABB(relativeStart, relativeMotion, 1.0f, { grown * -1.0f, grown }, &t)) return result;
+
+    Vector2 hit = relativeStart + relativeMotion * t;
+
+    // Past both faces means it came in over a corner, where the grown box is really a quarter circle.
+    // Missing that circle means missing the block altogether
+    if (fabsf(hit.x) > halfExtents.x && fabsf(hit.y) > halfExtents.y)
+    {
+        Vector2 corner = { hit.x > 0 ? halfExtents.x : -halfExtents.x, hit.y > 0 ? halfExtents.y : -halfExtents.y };
+        t = sweepPointCircle(relativeStart, relativeMotion, corner, radius);
+        if (t < 0) return result;
+
+        result.fraction = t;
+        result.normal = Vector2Normalize(relativeStart + relativeMotion * t - corner);
+        return result;
+    }
+
+    result.fraction = t;
+
+    // Whichever face it landed on
+    if (fabsf(hit.x) - grown.x > fabsf(hit.y) - grown.y)
+        result.normal = { hit.x > 0 ? 1.0f : -1.0f, 0.0f };
+    else
+        result.normal = { 0.0f, hit.y > 0 ? 1.0f : -1.0f };
+
+    return result;
+}
+
+TimeOfImpact CircleHalfspaceTOI(Vector2 start, Vector2 motion, float radius, Vector2 planePoint, Vector2 planeNormal)
+{
+    TimeOfImpact result;
+
+    // Gap between the circle's surface and the plane at the start and end of the step
+    float startGap = Vector2DotProduct(start - planePoint, planeNormal) - radius;
+    float endGap = startGap + Vector2DotProduct(motion, planeNormal);
+
+    if (startGap < 0 || endGap >= 0) return result;
+
+    result.fraction = startGap / (startGap - endGap);
+    result.normal = planeNormal;
+    return result;
+}
@@ -0,0 +1,59 @@
+#include "counters.h"
+
+#if ENGINE_COUNTERS
+
+#include "raygui.h"
+#include "rlgl.h"
+#include "world.h"
+
+void GatherPhysicsCounters(const PhysicsWorld& world, int physicsSteps, EngineCounters& counters)
+{
+    const BodyStore& bodies = world.bodies;
+
+    counters.circles = (int)bodies.circles.size();
+    counters.blocks = (int)bodies.blocks.size();
+    counters.halfspaces = (int)bodies.halfspaces.size();
+    counters.asleep = world.islands.getSleepingCount();
+
+    counters.candidatePairs = world.getCandidatePairCount();
+    counters.pairsTested = world.getStats().pairsTested;
+    counters.contacts = (int)world.getContacts().size();
+    counters.manifolds = (int)world.solver.getManifolds().size();
+    counters.velocityIterations = world.solver.velocityIterations;
+    counters.positionIterations = world.solver.positionIterations;
+    counters.physicsSteps = physicsSteps;
+}
+
+void GatherRenderCounters(EngineCounters& counters)
+{
+    rlRenderStats stats = rlGetRenderStats();
+    rlResetRenderStats();
+
+    counters.batchFlushes = stats.batchFlushes;
+    counters.drawCalls = stats.drawCalls;
+    counters.vertices = stats.vertices;
+}
+
+void DrawEngineCounters(const EngineCounters& counters, Rectangle bounds)
+{
+    GuiPanel(bounds, "Counters");
+
+    int x = (int)bounds.x + 10;
+    int y = (int)bounds.y + 32;
+    const int line = 16;
+
+    DrawText(TextFormat("bodies  %i circles  %i blocks  %i halfspaces  (%i asleep)", counters.circles, counters.blocks,
+        counters.halfspaces, counters.asleep), x, y, 10, WHITE);
+    y += line;
+    DrawText(TextFormat("pairs   %i candidates  %i tested", counters.candidatePairs, counters.pairsTested), x, y, 10, WHITE);
+    y += line;
+    DrawText(TextFormat("solver  %i contacts  %i manifolds  %i + %i iterations", counters.contacts, counters.manifolds,
+        counters.velocityIterations, counters.positionIterations), x, y, 10, WHITE);
+    y += line;
+    DrawText(TextFormat("steps   %i this frame", counters.physicsSteps), x, y, 10, WHITE);
+    y += line;
+    DrawText(TextFormat("rlgl    %i flushes  %i draw calls  %i vertices", counters.batchFlushes, counters.drawCalls, counters.vertices),
+        x, y, 10, WHITE);
+}
+
+#endif
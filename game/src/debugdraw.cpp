@@ -0,0 +1,85 @@
+#include "debugdraw.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+// A thick line as two triangles, same winding DrawLineEx uses
+static void emitLine(Vector2 from, Vector2 to, float thickness)
+{
+    Vector2 delta = to - from;
+    float length = Vector2Length(delta);
+    if (length <= 0.0f) return;
+
+    float scale = thickness / (2 * length);
+    Vector2 radius = { -scale * delta.y, scale * delta.x };
+
+    Vector2 p0 = from - radius;
+    Vector2 p1 = from + radius;
+    Vector2 p2 = to - radius;
+    Vector2 p3 = to + radius;
+
+    rlVertex2f(p2.x, p2.y); rlVertex2f(p0.x, p0.y); rlVertex2f(p1.x, p1.y);
+    rlVertex2f(p3.x, p3.y); rlVertex2f(p2.x, p2.y); rlVertex2f(p1.x, p1.y);
+}
+
+static void emitSquare(Vector2 center, float radius)
+{
+    rlVertex2f(center.x - radius, center.y - radius); rlVertex2f(center.x - radius, center.y + radius); rlVertex2f(center.x + radius, center.y + radius);
+    rlVertex2f(center.x - radius, center.y - radius); rlVertex2f(center.x + radius, center.y + radius); rlVertex2f(center.x + radius, center.y - radius);
+}
+
+// One triangle batch for the lot, rlgl starts a new draw call by itself if the buffer fills up
+void DebugDraw::flush() const
+{
+    if (commands.empty()) return;
+
+    rlBegin(RL_TRIANGLES);
+
+    for (int i = 0; i < commands.size(); i++)
+    {
+        const DebugCommand& command = commands[i];
+        if (!isEnabled(1u << command.category)) continue;
+
+        rlColor4ub(command.color.r, command.color.g, command.color.b, command.color.a);
+
+        switch (command.type)
+        {
+        case DEBUG_LINE:
+            emitLine(command.a, command.b, command.size);
+            break;
+
+        case DEBUG_ARROW:
+        {
+            emitLine(command.a, command.b, command.size);
+
+            // Head scales with the arrow but stays readable on short ones
+            Vector2 delta = command.b - command.a;
+            float length = Vector2Length(delta);
+            if (length <= 0.0f) break;
+
+            float headLength = fminf(10.0f, length * 0.3f);
+            Vector2 back = delta * (-headLength / length);
+            Vector2 side = { -back.y * 0.5f, back.x * 0.5f };
+            emitLine(command.b, command.b + back + side, command.size);
+            emitLine(command.b, command.b + back - side, command.size);
+            break;
+        }
+
+        case DEBUG_POINT:
+            emitSquare(command.a, command.size);
+            break;
+
+        case DEBUG_BOX:
+        {
+            Vector2 topRight = { command.b.x, command.a.y };
+            Vector2 bottomLeft = { command.a.x, command.b.y };
+            emitLine(command.a, topRight, command.size);
+            emitLine(topRight, command.b, command.size);
+            emitLine(command.b, bottomLeft, command.size);
+            emitLine(bottomLeft, command.a, command.size);
+            break;
+        }
+        }
+    }
+
+    rlEnd();
+}
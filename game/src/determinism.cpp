@@ -0,0 +1,82 @@
+#include "determinism.h"
+#include <cfenv>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DETERMINISM_SSE_CSR 1
+#endif
+
+// Flush to zero (bit 15) and denormals are zero (bit 6), both turned on by some audio and graphics libraries
+static const unsigned int FTZ_DAZ_BITS = 0x8040;
+
+void SetDeterministicFloatEnvironment()
+{
+    fesetround(FE_TONEAREST);
+
+#ifdef DETERMINISM_SSE_CSR
+    _mm_setcsr(_mm_getcsr() & ~FTZ_DAZ_BITS);
+#endif
+}
+
+bool IsDeterministicFloatEnvironment()
+{
+    if (fegetround() != FE_TONEAREST) return false;
+
+#ifdef DETERMINISM_SSE_CSR
+    if (_mm_getcsr() & FTZ_DAZ_BITS) return false;
+#endif
+
+    return true;
+}
+
+static const uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ull;
+static const uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+
+static uint64_t rotateLeft(uint64_t x, int bits)
+{
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static uint64_t mix(uint64_t hash, uint64_t word)
+{
+    return rotateLeft(hash ^ (word * HASH_PRIME_2), 31) * HASH_PRIME_1;
+}
+
+// Final avalanche so nearby inputs don't give nearby hashes
+static uint64_t finish(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed ^ (size * HASH_PRIME_1);
+
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = mix(hash, word);
+    }
+
+    if (i < size)
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, size - i);
+        hash = mix(hash, word);
+    }
+
+    return finish(hash);
+}
+
+uint64_t HashCombine(uint64_t hash, uint64_t value)
+{
+    return finish(mix(hash, value));
+}
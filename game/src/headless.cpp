@@ -0,0 +1,252 @@
+// Headless runner: the same PhysicsWorld as the game with no window, no GL context and no
+// frame limiter, stepping as fast as the CPU goes. Only needs raylib's headers, nothing gets
+// linked from it, so it builds on boxes without a display. Not part of the Visual Studio
+// project since it has its own main.
+//
+// Also the determinism checker: --hashes writes the world hash after every step, and --compare
+// reruns against a file written that way (other thread count, other build, other machine) and
+// stops at the first step that doesn't match.
+//
+// --trace FILE times every phase of every step and writes them out as a Chrome trace, for
+// chrome://tracing or Perfetto.
+//
+// --sweep N runs N launches against the tower instead, an angle by speed grid stepped as a WorldBatch
+// across every thread, and prints what each one did (or writes it to --csv FILE) with the throughput.
+//
+//   g++ -std=c++17 -O2 -ffp-contract=off -Igame/include -Iraylib-5.5/src game/src/headless.cpp game/src/world.cpp game/src/profiler.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/aabbtree.cpp game/src/narrowphase.cpp game/src/solver.cpp game/src/islands.cpp game/src/integrator.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp game/src/ccd.cpp game/src/paircache.cpp game/src/planes.cpp game/src/worldbatch.cpp -o headless -pthread
+//   ./headless [--steps N] [--threads N] [--circles N] [--blocks N] [--hashes FILE] [--compare FILE] [--trace FILE]
+//   ./headless --sweep N [--mass N] [--blocks N] [--steps N] [--threads N] [--csv FILE]
+
+#include "raylib.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "world.h"
+#include "worldbatch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct HeadlessOptions
+{
+    int steps = 3600;
+    int threads = 0; // every hardware thread
+    int circles = 500;
+    int blocks = 5; // tower height
+    const char* hashesPath = nullptr; // write every step's hash here
+    const char* comparePath = nullptr; // check every step's hash against this
+    int sweep = 0; // launches to sweep, 0 for the normal run
+    int mass = 1; // launched circle's mass in a sweep
+    const char* csvPath = nullptr; // every sweep outcome goes here instead of the console
+    const char* tracePath = nullptr; // every step's zones go here
+};
+
+static HeadlessOptions parseOptions(int argc, char** argv)
+{
+    HeadlessOptions options;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        int value = atoi(argv[i + 1]);
+
+        if (strcmp(argv[i], "--steps") == 0) options.steps = value;
+        else if (strcmp(argv[i], "--threads") == 0) options.threads = value;
+        else if (strcmp(argv[i], "--circles") == 0) options.circles = value;
+        else if (strcmp(argv[i], "--blocks") == 0) options.blocks = value;
+        else if (strcmp(argv[i], "--hashes") == 0) options.hashesPath = argv[i + 1];
+        else if (strcmp(argv[i], "--compare") == 0) options.comparePath = argv[i + 1];
+        else if (strcmp(argv[i], "--sweep") == 0) options.sweep = value;
+        else if (strcmp(argv[i], "--mass") == 0) options.mass = value;
+        else if (strcmp(argv[i], "--csv") == 0) options.csvPath = argv[i + 1];
+        else if (strcmp(argv[i], "--trace") == 0) options.tracePath = argv[i + 1];
+        else printf("unknown option %s\n", argv[i]);
+    }
+
+    return options;
+}
+
+// Same ground and tower as the game, with a grid of circles dropped over it
+static void buildScene(PhysicsWorld& world, const HeadlessOptions& options)
+{
+    world.addHalfspace({ 600, 700 }, 0);
+
+    float blockSize = 30;
+
+    for (int i = 0; i < options.blocks; i++)
+    {
+        Vector2 halfExtents = { blockSize, blockSize };
+
+        if (i == 0)
+            halfExtents = { blockSize * 10, blockSize };
+
+        int block = world.addBlock({ 800, 650 - i * (halfExtents.y * 2 + 2) }, halfExtents, 5);
+
+        if (i == 0)
+            world.bodies.setStatic(block, true);
+    }
+
+    for (int i = 0; i < options.circles; i++)
+    {
+        Vector2 pos = { 100.0f + (i % 40) * 25.0f, 500.0f - (i / 40) * 25.0f };
+        world.addCircle(pos, 10.0f, 1.0f);
+    }
+}
+
+// Angles from 10 to 80 degrees by speeds from 100 to 600, as square a grid as the count allows
+static int runSweep(const HeadlessOptions& options, JobSystem& jobs)
+{
+    PhysicsWorld scene;
+    scene.killY = 2000;
+    HeadlessOptions towerOnly = options;
+    towerOnly.circles = 0;
+    buildScene(scene, towerOnly);
+
+    int columns = 1;
+    while (columns * columns < options.sweep) columns++;
+    int rows = (options.sweep + columns - 1) / columns;
+
+    std::vector<LaunchParameters> launches(options.sweep);
+
+    for (int i = 0; i < options.sweep; i++)
+    {
+        launches[i].angle = 10.0f + 70.0f * (i % columns) / (columns > 1 ? columns - 1 : 1);
+        launches[i].speed = 100.0f + 500.0f * (i / columns) / (rows > 1 ? rows - 1 : 1);
+        launches[i].circleMass = (float)options.mass;
+    }
+
+    WorldBatch batch;
+    batch.arena = { { -500, -INFINITY }, { 2500, 2000 } };
+    batch.reset(scene, launches);
+    batch.run(options.steps, 1.0f / 60.0f, &jobs);
+
+    FILE* out = stdout;
+    if (options.csvPath != nullptr && (out = fopen(options.csvPath, "w")) == nullptr)
+    {
+        printf("can't write %s\n", options.csvPath);
+        return 1;
+    }
+
+    int toppledAny = 0;
+    int settled = 0;
+    fprintf(out, "angle,speed,mass,blocks_toppled,settle_time,impact_energy,steps\n");
+
+    for (int i = 0; i < batch.getWorldCount(); i++)
+    {
+        const LaunchParameters& launch = launches[i];
+        const LaunchOutcome& outcome = batch.getOutcome(i);
+        fprintf(out, "%.2f,%.1f,%.1f,%d,%.3f,%.1f,%d\n", launch.angle, launch.speed, launch.circleMass, outcome.blocksToppled,
+            outcome.settleTime, outcome.impactEnergy, outcome.steps);
+
+        if (outcome.blocksToppled > 0) toppledAny++;
+        if (outcome.settleTime >= 0) settled++;
+    }
+
+    if (out != stdout) fclose(out);
+
+    printf("%d launches on %d threads: %lld world steps in %.3f s, %.0f world steps/sec\n", batch.getWorldCount(), jobs.getThreadCount(),
+        batch.getWorldSteps(), batch.getSeconds(), batch.getWorldStepsPerSecond());
+    printf("%d knocked something over, %d settled within %d steps\n", toppledAny, settled, options.steps);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options = parseOptions(argc, argv);
+
+    JobSystem jobs(options.threads);
+
+    if (options.sweep > 0)
+        return runSweep(options, jobs);
+    PhysicsWorld world;
+    world.jobs = &jobs;
+    world.killY = 2000; // well under the ground, only things knocked off the edge of the world
+
+    buildScene(world, options);
+
+    FILE* hashes = nullptr;
+    FILE* compare = nullptr;
+
+    if (options.hashesPath != nullptr && (hashes = fopen(options.hashesPath, "w")) == nullptr)
+    {
+        printf("can't write %s\n", options.hashesPath);
+        return 1;
+    }
+
+    if (options.comparePath != nullptr && (compare = fopen(options.comparePath, "r")) == nullptr)
+    {
+        printf("can't read %s\n", options.comparePath);
+        return 1;
+    }
+
+    world.deterministic = hashes != nullptr || compare != nullptr;
+
+    // Every step is a frame as far as the profiler is concerned
+    Profiler profiler;
+    profilingEnabled = options.tracePath != nullptr;
+    if (profilingEnabled) profiler.startCapture();
+
+    const float dt = 1.0f / 60.0f;
+    int divergedStep = -1;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < options.steps; i++)
+    {
+        world.step(dt);
+        if (profilingEnabled) profiler.endFrame();
+
+        if (hashes != nullptr)
+            fprintf(hashes, "%d %016llx\n", world.getStepCount(), (unsigned long long)world.getStepHash());
+
+        if (compare != nullptr)
+        {
+            int expectedStep;
+            unsigned long long expectedHash;
+
+            if (fscanf(compare, "%d %llx", &expectedStep, &expectedHash) != 2)
+            {
+                printf("%s ends after step %d, nothing left to compare\n", options.comparePath, i);
+                fclose(compare);
+                compare = nullptr;
+            }
+            else if (expectedHash != world.getStepHash())
+            {
+                divergedStep = world.getStepCount();
+                printf("runs diverge at step %d: expected %016llx, got %016llx\n", divergedStep, expectedHash,
+                    (unsigned long long)world.getStepHash());
+                break;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d steps on %d threads in %.3f s, %.0f steps/sec (%.1fx real time)\n", options.steps, jobs.getThreadCount(), seconds,
+        options.steps / seconds, options.steps * dt / seconds);
+    printf("bodies %d  islands %d  sleeping %d  contacts %d\n", world.bodies.size(), world.islands.getIslandCount(),
+        world.islands.getSleepingCount(), (int)world.getContacts().size());
+
+    if (world.deterministic)
+        printf("rolling hash %016llx after %d steps\n", (unsigned long long)world.getRollingHash(), world.getStepCount());
+
+    if (hashes != nullptr) fclose(hashes);
+
+    if (profilingEnabled)
+    {
+        for (int zone = 0; zone < profiler.getZoneCount(); zone++)
+            printf("  %-12s %.3f ms\n", profiler.getZoneName(zone), profiler.getAverageZoneTime(zone));
+
+        if (profiler.writeChromeTrace(options.tracePath))
+            printf("%d zones written to %s\n", profiler.getCapturedCount(), options.tracePath);
+        else
+            printf("can't write %s\n", options.tracePath);
+    }
+
+    if (compare != nullptr)
+    {
+        fclose(compare);
+        if (divergedStep < 0) printf("every step matches %s\n", options.comparePath);
+    }
+
+    return divergedStep < 0 ? 0 : 1;
+}
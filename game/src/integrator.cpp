@@ -0,0 +1,146 @@
+#include "integrator.h"
+#include "bodystore.h"
+#include "jobs.h"
+#include "simd.h"
+#include <cstring>
+
+static void integrateScalar(Vector2* position, Vector2* velocity, Vector2* force, const float* invMass, const unsigned char* asleep, int begin, int end, Vector2 gravity, float dt)
+{
+    for (int i = begin; i < end; i++)
+    {
+        // Same operations in the same order as the SIMD paths so they all agree bit for bit
+        if (invMass[i] != 0.0f && asleep[i] == 0)
+        {
+            position[i].x += velocity[i].x * dt;
+            position[i].y += velocity[i].y * dt;
+
+            velocity[i].x += (force[i].x * invMass[i] + gravity.x) * dt;
+            velocity[i].y += (force[i].y * invMass[i] + gravity.y) * dt;
+        }
+
+        force[i] = { 0, 0 };
+    }
+}
+
+#if SIMD_X64
+
+// Vector2 arrays are interleaved x, y, x, y so a register holds whole bodies and every lane is used.
+// invMass and the awake mask get spread out to match: { m0, m0, m1, m1 }
+static void integrateSSE(Vector2* position, Vector2* velocity, Vector2* force, const float* invMass, const unsigned char* asleep, int count, Vector2 gravity, float dt)
+{
+    const __m128 g = _mm_setr_ps(gravity.x, gravity.y, gravity.x, gravity.y);
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i zeroInt = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 m = _mm_loadu_ps(invMass + i);
+        __m128 mass[2] = { _mm_unpacklo_ps(m, m), _mm_unpackhi_ps(m, m) };
+
+        // 4 sleep flags widened from bytes to one 32 bit lane each
+        int flags;
+        memcpy(&flags, asleep + i, sizeof(flags));
+        __m128i widened = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(flags), zeroInt), zeroInt);
+        __m128 awake = _mm_castsi128_ps(_mm_cmpeq_epi32(widened, zeroInt));
+        __m128 awakeLanes[2] = { _mm_unpacklo_ps(awake, awake), _mm_unpackhi_ps(awake, awake) };
+
+        for (int half = 0; half < 2; half++)
+        {
+            float* p = &position[i + half * 2].x;
+            float* v = &velocity[i + half * 2].x;
+            float* f = &force[i + half * 2].x;
+
+            __m128 moving = _mm_and_ps(_mm_cmpneq_ps(mass[half], zero), awakeLanes[half]);
+            __m128 pos = _mm_loadu_ps(p);
+            __m128 vel = _mm_loadu_ps(v);
+            __m128 acc = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(f), mass[half]), g);
+
+            // Static lanes keep their old values untouched
+            __m128 newPos = _mm_add_ps(pos, _mm_mul_ps(vel, step));
+            __m128 newVel = _mm_add_ps(vel, _mm_mul_ps(acc, step));
+            pos = _mm_or_ps(_mm_and_ps(moving, newPos), _mm_andnot_ps(moving, pos));
+            vel = _mm_or_ps(_mm_and_ps(moving, newVel), _mm_andnot_ps(moving, vel));
+
+            _mm_storeu_ps(p, pos);
+            _mm_storeu_ps(v, vel);
+            _mm_storeu_ps(f, zero);
+        }
+    }
+
+    integrateScalar(position, velocity, force, invMass, asleep, i, count, gravity, dt);
+}
+
+SIMD_AVX2_TARGET
+static void integrateAVX2(Vector2* position, Vector2* velocity, Vector2* force, const float* invMass, const unsigned char* asleep, int count, Vector2 gravity, float dt)
+{
+    const __m256 g = _mm256_setr_ps(gravity.x, gravity.y, gravity.x, gravity.y, gravity.x, gravity.y, gravity.x, gravity.y);
+    const __m256 step = _mm256_set1_ps(dt);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i spreadLow = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i spreadHigh = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 m = _mm256_loadu_ps(invMass + i);
+        __m256 mass[2] = { _mm256_permutevar8x32_ps(m, spreadLow), _mm256_permutevar8x32_ps(m, spreadHigh) };
+
+        __m256i flags = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(asleep + i)));
+        __m256 awake = _mm256_castsi256_ps(_mm256_cmpeq_epi32(flags, _mm256_setzero_si256()));
+        __m256 awakeLanes[2] = { _mm256_permutevar8x32_ps(awake, spreadLow), _mm256_permutevar8x32_ps(awake, spreadHigh) };
+
+        for (int half = 0; half < 2; half++)
+        {
+            float* p = &position[i + half * 4].x;
+            float* v = &velocity[i + half * 4].x;
+            float* f = &force[i + half * 4].x;
+
+            __m256 moving = _mm256_and_ps(_mm256_cmp_ps(mass[half], zero, _CMP_NEQ_UQ), awakeLanes[half]);
+            __m256 pos = _mm256_loadu_ps(p);
+            __m256 vel = _mm256_loadu_ps(v);
+            __m256 acc = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(f), mass[half]), g);
+
+            __m256 newPos = _mm256_add_ps(pos, _mm256_mul_ps(vel, step));
+            __m256 newVel = _mm256_add_ps(vel, _mm256_mul_ps(acc, step));
+            pos = _mm256_blendv_ps(pos, newPos, moving);
+            vel = _mm256_blendv_ps(vel, newVel, moving);
+
+            _mm256_storeu_ps(p, pos);
+            _mm256_storeu_ps(v, vel);
+            _mm256_storeu_ps(f, zero);
+        }
+    }
+
+    integrateScalar(position, velocity, force, invMass, asleep, i, count, gravity, dt);
+}
+
+#endif
+
+void IntegrateBodies(SimdLevel level, Vector2* position, Vector2* velocity, Vector2* force, const float* invMass, const unsigned char* asleep, int count, Vector2 gravity, float dt)
+{
+    // Asking for a level the CPU can't run falls back instead of crashing
+    if (!SimdLevelSupported(level)) level = BestSimdLevel();
+
+    switch (level)
+    {
+#if SIMD_X64
+    case SIMD_AVX2: integrateAVX2(position, velocity, force, invMass, asleep, count, gravity, dt); break;
+    case SIMD_SSE: integrateSSE(position, velocity, force, invMass, asleep, count, gravity, dt); break;
+#endif
+    default: integrateScalar(position, velocity, force, invMass, asleep, 0, count, gravity, dt); break;
+    }
+}
+
+void IntegrateBodies(BodyStore& bodies, Vector2 gravity, float dt, JobSystem* jobs)
+{
+    SimdLevel level = BestSimdLevel();
+
+    // Every body is independent, ranges are a multiple of 8 so only the last one has a tail
+    ParallelFor(jobs, bodies.size(), 4096, [&](int begin, int end, int chunk)
+    {
+        IntegrateBodies(level, bodies.position.data() + begin, bodies.velocity.data() + begin, bodies.force.data() + begin,
+            bodies.invMass.data() + begin, bodies.asleep.data() + begin, end - begin, gravity, dt);
+    });
+}
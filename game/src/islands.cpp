@@ -0,0 +1,166 @@
+#include "islands.h"
+#include "bodystore.h"
+#include "solver.h"
+#include "raymath.h"
+#include <cfloat>
+#include <cmath>
+
+void IslandGraph::build(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds)
+{
+    parent.resize(bodies.size());
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        parent[i] = bodies.isStatic(i) ? -1 : i;
+    }
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        int a = manifolds[i].a;
+        int b = manifolds[i].b;
+
+        // Static bodies don't carry anything across
+        if (parent[a] < 0 || parent[b] < 0) continue;
+
+        int rootA = find(a);
+        int rootB = find(b);
+
+        // Lowest index always ends up the root so the islands come out the same every run
+        if (rootA < rootB) parent[rootB] = rootA;
+        else if (rootB < rootA) parent[rootA] = rootB;
+    }
+}
+
+// Path halving, every other node on the way up gets pointed at its grandparent
+int IslandGraph::find(int body)
+{
+    if (parent[body] < 0) return -1;
+
+    while (parent[body] != body)
+    {
+        parent[body] = parent[parent[body]];
+        body = parent[body];
+    }
+
+    return body;
+}
+
+void IslandGraph::groupManifolds(const std::vector<ContactManifold>& manifolds, std::vector<int>& order, std::vector<int>& islandStarts)
+{
+    islandIndex.assign(parent.size(), -1);
+    islandStarts.clear();
+    order.resize(manifolds.size());
+
+    // Counting sort: number the islands as they first show up and count their manifolds
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        if (manifolds[i].asleep) continue;
+
+        // At least one side moves, static vs static never makes it into the solver
+        int root = find(manifolds[i].a);
+        if (root < 0) root = find(manifolds[i].b);
+
+        if (islandIndex[root] < 0)
+        {
+            islandIndex[root] = (int)islandStarts.size();
+            islandStarts.push_back(0);
+        }
+
+        islandStarts[islandIndex[root]]++;
+    }
+
+    // Counts to start offsets, with one extra on the end so every island has an end
+    int total = 0;
+
+    for (int i = 0; i < islandStarts.size(); i++)
+    {
+        int count = islandStarts[i];
+        islandStarts[i] = total;
+        total += count;
+    }
+
+    islandStarts.push_back(total);
+    order.resize(total);
+
+    // Second pass drops every manifold into its island's slot, still in their old order
+    cursor.assign(islandStarts.begin(), islandStarts.end() - 1);
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        if (manifolds[i].asleep) continue;
+
+        int root = find(manifolds[i].a);
+        if (root < 0) root = find(manifolds[i].b);
+
+        order[cursor[islandIndex[root]]++] = i;
+    }
+}
+
+void Islands::wake(BodyStore& bodies, const std::vector<int>& bodiesToWake, const std::vector<ContactManifold>& manifolds)
+{
+    if (bodiesToWake.empty()) return;
+
+    graph.build(bodies, manifolds);
+
+    // Reusing islandAwake as a flag per root
+    islandAwake.assign(bodies.size(), 0);
+
+    for (int i = 0; i < bodiesToWake.size(); i++)
+    {
+        int root = graph.find(bodiesToWake[i]);
+        if (root >= 0) islandAwake[root] = 1;
+    }
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        int root = graph.find(i);
+        if (root >= 0 && islandAwake[root]) bodies.wake(i);
+    }
+}
+
+void Islands::updateSleep(BodyStore& bodies, const std::vector<ContactManifold>& manifolds, float dt)
+{
+    graph.build(bodies, manifolds);
+
+    islandSleepTime.assign(bodies.size(), FLT_MAX);
+    islandAwake.assign(bodies.size(), 0);
+    islandCount = 0;
+    sleepingCount = 0;
+
+    float toleranceSquared = linearSleepTolerance * linearSleepTolerance;
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        int root = graph.find(i);
+        if (root < 0) continue;
+        if (root == i) islandCount++;
+
+        if (!sleepingEnabled)
+        {
+            bodies.wake(i);
+            continue;
+        }
+
+        if (bodies.asleep[i]) continue;
+
+        if (Vector2LengthSqr(bodies.velocity[i]) > toleranceSquared)
+            bodies.sleepTime[i] = 0;
+        else
+            bodies.sleepTime[i] += dt;
+
+        islandAwake[root] = 1;
+        islandSleepTime[root] = fminf(islandSleepTime[root], bodies.sleepTime[i]);
+    }
+
+    // Islands only go to sleep as a whole, the slowest to settle decides for everyone
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        int root = graph.find(i);
+        if (root < 0) continue;
+
+        if (islandAwake[root] && !bodies.asleep[i] && islandSleepTime[root] >= timeToSleep)
+            bodies.sleep(i);
+
+        if (bodies.asleep[i]) sleepingCount++;
+    }
+}
@@ -0,0 +1,174 @@
+#include "jobs.h"
+#include "determinism.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct Job
+{
+    void (*function)(void* context, int chunk);
+    void* context;
+    int chunk;
+    std::atomic<int>* pending;
+};
+
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<Job> jobs;
+};
+
+struct JobSystem::Pool
+{
+    std::vector<std::thread> workers;
+    std::vector<WorkQueue> queues; // 0 is for threads outside the pool, workers get 1 and up
+
+    std::atomic<int> queuedJobs{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wakeSignal;
+    bool quitting = false;
+
+    bool findJob(int queue, Job& job);
+    void workerLoop(int queue);
+};
+
+// Which queue the current thread owns, threads outside the pool all share queue 0
+static thread_local int currentQueue = 0;
+
+static void runJob(const Job& job)
+{
+    job.function(job.context, job.chunk);
+    job.pending->fetch_sub(1, std::memory_order_release);
+}
+
+JobSystem::JobSystem(int threads)
+{
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    threadCount = threads;
+    pool = new Pool();
+
+    // std::mutex can't move, so the queues get sized once up front
+    pool->queues = std::vector<WorkQueue>(threadCount);
+
+    for (int i = 1; i < threadCount; i++)
+    {
+        pool->workers.emplace_back(&Pool::workerLoop, pool, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool->sleepMutex);
+        pool->quitting = true;
+    }
+
+    pool->wakeSignal.notify_all();
+
+    for (int i = 0; i < pool->workers.size(); i++)
+    {
+        pool->workers[i].join();
+    }
+
+    delete pool;
+}
+
+void JobSystem::runChunks(JobFunction function, void* context, int chunkCount)
+{
+    std::atomic<int> pending(chunkCount);
+    int queue = currentQueue;
+    WorkQueue& own = pool->queues[queue];
+
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+
+        // Backwards so this thread pops chunk 0 first while thieves take the far end
+        for (int chunk = chunkCount - 1; chunk >= 0; chunk--)
+        {
+            own.jobs.push_back({ function, context, chunk, &pending });
+        }
+
+        pool->queuedJobs += chunkCount;
+    }
+
+    {
+        // Taking the lock orders this against a worker checking queuedJobs before it waits
+        std::lock_guard<std::mutex> lock(pool->sleepMutex);
+    }
+
+    pool->wakeSignal.notify_all();
+
+    // Help out until every chunk is done, including ones other threads took
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        Job job;
+
+        if (pool->findJob(queue, job))
+            runJob(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+bool JobSystem::Pool::findJob(int queue, Job& job)
+{
+    // Own queue from the back, newest first, it's the most likely to still be in cache
+    {
+        WorkQueue& own = queues[queue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+
+        if (!own.jobs.empty())
+        {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            queuedJobs--;
+            return true;
+        }
+    }
+
+    // Then steal the oldest job from everyone else in turn
+    for (int i = 1; i < queues.size(); i++)
+    {
+        WorkQueue& victim = queues[(queue + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            queuedJobs--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Pool::workerLoop(int queue)
+{
+    currentQueue = queue;
+
+    // Workers always start from the float environment a deterministic step pins on the calling thread,
+    // so chunks give the same answer on every thread
+    SetDeterministicFloatEnvironment();
+
+    while (true)
+    {
+        Job job;
+
+        if (findJob(queue, job))
+        {
+            runJob(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeSignal.wait(lock, [this]() { return quitting || queuedJobs > 0; });
+
+        if (quitting) return;
+    }
+}
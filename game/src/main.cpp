@@ -3,637 +3,356 @@
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
 #include "game.h"
+#include "bodystore.h"
+#include "counters.h"
+#include "debugdraw.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "profileoverlay.h"
+#include "rlgl.h"
+#include "trajectory.h"
+#include "world.h"
 #include <vector>
 
 const unsigned int TARGET_FPS = 60; // frames per second
+const float PHYSICS_DT = 1.0f / 60.0f; // physics always steps by this, whatever the frame rate
+const int MAX_SUBSTEPS = 5; // physics steps per frame before it stops trying to catch up
+const float MAX_FRAME_TIME = 0.25f; // longer frames (dragging the window, breakpoints) count as this
 
 float lpmSpeed = 100;
-float dt = 1; // seconds per frame
+float dt = PHYSICS_DT; // seconds per physics step
 float time = 0;
+float accumulator = 0; // frame time physics hasn't caught up on yet
+float renderAlpha = 1; // how far between the last two physics steps to draw, 0 to 1
+int stepsThisFrame = 0;
+int contactsBegunThisFrame = 0;
+int contactsEndedThisFrame = 0;
+bool lockstep = false; // L toggles: exactly one physics step per frame, inputs always land on the same step
 
 Vector2 launchPos;
 
 Vector2 velocity;
 
-Vector2 gravityAcceleration = { 0, 100 };
 float launchAngle;
 float launchSpeed;
 float rad;
 
 float circleMass = 1.0f;
+bool bulletBirds = true; // launched circles get swept so they can't pass through thin things at high speed
 int currentBirdType = 1;
 
-enum PhysicsShape
-{
-    CIRCLE,
-    HALF_SPACE,
-    BLOCK
-};
+PhysicsWorld world;
+BodyStore& bodies = world.bodies;
+Vector2& gravityAcceleration = world.gravity;
+JobSystem jobs; // one thread per core, the physics step spreads over all of them
+DebugDraw debugDraw; // the world records into it every step, draw() flushes it
+PhysicsHalfspace halfspace;
+BodyHandle pickedBody; // right click to inspect a body, stops resolving once the body is gone
+WorldSnapshot savedWorld; // F5 saves the whole sandbox, F9 puts it back
+float savedTime = -1; // time when savedWorld was taken, -1 before the first save
+std::vector<Vector2> predictedPath; // where the next circle will fly, redone every frame
+std::vector<AimSolution> aimSolutions; // launches that hit the picked block
+int aimChoice = -1; // slowest of aimSolutions the angle slider can reach, T takes it
+Profiler profiler; // times every zone each frame, P shows the graphs
+bool showProfiler = false;
+#if ENGINE_COUNTERS
+EngineCounters counters; // C shows them, debug builds only
+bool showCounters = false;
+#endif
+//PhysicsHalfspace halfspace2;
 
-class PhysicsBody
+// Holding backspace clears every circle. Each removal moves the last body into i, so i gets checked again
+void cleanup()
 {
-public:
-    bool isStatic = false; // If this is set to true, don't move the object according to velocity or gravity
-    Vector2 position{};
-    Vector2 projectileVelo{}; // Pixels per sec
-    Vector2 netForce = {}; // in Newtons
-    float mass = 1;
-    float coefficientOfFriction = 0.5f;
-    float bounciness = 0.9f; // for determing coefficient of restitution
+    if (!IsKeyDown(KEY_BACKSPACE)) return;
 
-    virtual void draw() {}
-
-    virtual PhysicsShape Shape() = 0;
-};
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (bodies.shape[i] == CIRCLE)
+        {
+            world.removeBody(i);
+            i--;
+        }
+    }
+}
 
-class PhysicsCircle : public PhysicsBody
+// One checkbox per debug draw category
+void debugCategoryToggle(float y, const char* text, unsigned int category)
 {
-public:
-    Color color = GREEN;
-    float radius = 30.0f;
-    //float timer = 0.0f;
-    bool isTimerActive = true;
+    bool on = debugDraw.isEnabled(category);
+    GuiCheckBox(Rectangle{ 900, y, 20, 20 }, text, &on);
+    if (on != debugDraw.isEnabled(category)) debugDraw.toggle(category);
+}
 
-    void draw() override
-    {
-        DrawCircleV(position, radius, color);
-        DrawText(TextFormat("%.1f", mass), position.x - 14, position.y - 12, 25, BLACK);
-    }
+void spawnCircle(Vector2 spawnLocation, float mass, float friction, Color color)
+{
+    // Adds a new circle to the body store
+    PhysicsCircle newCircle(&bodies, world.addCircle(spawnLocation, 30.0f, mass));
+    newCircle.material().coefficientOfFriction = friction;
+    newCircle.projectileVelo() = velocity;
+    newCircle.color() = color;
+    newCircle.setBullet(bulletBirds);
+}
 
-    PhysicsShape Shape() override
-    {
-        return CIRCLE;
-    }
-};
+void spawnBlock(Vector2 pos)
+{
+    PhysicsBlock newBlock(&bodies, world.addBlock(pos, { 30, 30 }, circleMass));
+    newBlock.color() = BLACK;
+    newBlock.projectileVelo() = velocity;
+}
 
-class PhysicsHalfspace : public PhysicsBody
+// One fixed physics step
+void step()
 {
-    // distance to the normal hints: a dot b * (b/||b||) ||b|| referring to magnitude
-    // dot product: a.x * b.x + a.y * b.y
-private:
-    float rotation = 0;
-    Vector2 normal = { 0, -1 };
+    time += dt;
 
-public:
+    // Anything under the bottom of the window is gone for good
+    world.killY = GetScreenHeight();
+    world.step(dt);
 
-    int id = 0;
+    // Events only cover the one step, a frame can run several
+    contactsBegunThisFrame += (int)world.getPairCache().getBeginEvents().size();
+    contactsEndedThisFrame += (int)world.getPairCache().getEndEvents().size();
+}
 
-    void setRotationDegrees(float rotationInDeg)
-    {
-        rotation = rotationInDeg;
-        normal = Vector2Rotate({ 0, -1 }, rotation * DEG2RAD);
-    }
+void update()
+{
+    float frameTime = GetFrameTime();
+    rad = launchAngle * DEG2RAD;
 
-    float getRotation()
+    if (IsKeyPressed(KEY_L))
     {
-        return rotation;
+        lockstep = !lockstep;
+        world.deterministic = lockstep;
     }
 
-    Vector2 getNormal()
-    {
-        return normal;
-    }
+    // Nothing may depend on how long a frame took, or a replay drifts
+    if (lockstep)
+        frameTime = dt;
 
-    void draw() override
-    {
-        DrawCircle(position.x, position.y, 8, RED);
+    if (IsKeyPressed(KEY_ONE))
+        currentBirdType = 1;
 
-        DrawLineEx(position, position + normal * 30, 1, RED);
+    if (IsKeyPressed(KEY_TWO))
+        currentBirdType = 2;
 
-        Vector2 parallelToSurface = Vector2Rotate(normal, PI * 0.5f);
+    if (IsKeyPressed(KEY_P))
+        showProfiler = !showProfiler;
 
-        //for (int i = 0; i < 40; i++) 
-        //{
-        //    float offset = i * 50 + 25;
-        //    Vector2 oppositeVec = normal * -offset;
-        //    DrawLineEx(position - parallelToSurface * 2000 + oppositeVec, position + parallelToSurface * 2000 + oppositeVec, 50, DARKGREEN);
-        //}
+#if ENGINE_COUNTERS
+    if (IsKeyPressed(KEY_C))
+        showCounters = !showCounters;
+#endif
 
-        DrawLineEx(position - parallelToSurface * 2000, position + parallelToSurface * 2000, 1, RED);
-    }
+    // Start Position Movement, once a frame so it uses the frame time
+    if (IsKeyDown(KEY_W))
+        launchPos.y -= lpmSpeed * frameTime;
+    if (IsKeyDown(KEY_S))
+        launchPos.y += lpmSpeed * frameTime;
+    if (IsKeyDown(KEY_A))
+        launchPos.x -= lpmSpeed * frameTime;
+    if (IsKeyDown(KEY_D))
+        launchPos.x += lpmSpeed * frameTime;
 
-    PhysicsShape Shape() override
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT))
     {
-        return HALF_SPACE;
+        int body = world.pickBody(GetMousePosition());
+        pickedBody = body >= 0 ? bodies.getHandle(body) : BodyHandle();
     }
-};
-
-class PhysicsBlock : public PhysicsBody
-{
-public:
-    Vector2 halfExtents = { 20, 20 };
-    Color color = BROWN;
-    bool isBird = false;
 
-    void draw() override
+    // Spawn launch bird
+    if (IsKeyPressed(KEY_SPACE))
     {
-        float left = position.x - halfExtents.x;
-        float top = position.y - halfExtents.y;
-
-        DrawRectangle(left, top, halfExtents.x * 2, halfExtents.y * 2, color);
-
-        DrawRectangleLines(left, top, halfExtents.x * 2, halfExtents.y * 2, BLACK);
-
-        DrawText(TextFormat("%.1f", mass), position.x - 14, position.y - 12, 25, WHITE);
+        if (currentBirdType == 1)
+            spawnCircle(launchPos, circleMass, 0.5f, GREEN);
+        if (currentBirdType == 2)
+            spawnBlock(launchPos);
     }
 
-    PhysicsShape Shape() override 
-    { 
-        return BLOCK; 
-    }
-};
+    // Kick the picked body upwards, wakes it and whatever it's resting on
+    int picked = bodies.indexOf(pickedBody);
+    if (IsKeyPressed(KEY_F) && picked >= 0 && !bodies.isStatic(picked))
+        bodies.applyImpulse(picked, { 0, -300 * bodies.mass[picked] });
 
-std::vector<PhysicsBody*> objects;
-PhysicsHalfspace halfspace;
-//PhysicsHalfspace halfspace2;
-
-bool HalfspaceOverlap(PhysicsCircle* circle, PhysicsHalfspace* halfspace)
-{
-    Vector2 displacementToCircle = circle->position - halfspace->position;
-
-    float dot = Vector2DotProduct(displacementToCircle, halfspace->getNormal());
-    Vector2 vectorProjection = halfspace->getNormal() * dot;
-
-    //DrawLineEx(circle->position, circle->position - vectorProjection, 1, GRAY);
-    //Vector2 midpoint = circle->position - vectorProjection * 0.5f;
-    //DrawText(TextFormat("D: %3.0f", dot), midpoint.x, midpoint.y, 30, GRAY);
-
-    float overlapHalfspace = circle->radius - dot;
-
-    if (overlapHalfspace > 0)
+    // Aim at the picked block
+    if (IsKeyPressed(KEY_T) && aimChoice >= 0)
     {
-        //if (halfspace->id == 2)
-        //{
-        //    circle->isTimerActive = false;
-        //}
-
-        Vector2 mtv = halfspace->getNormal() * overlapHalfspace;
-        circle->position += mtv;
-
-        // Get Gravity
-        Vector2 FGravity = gravityAcceleration * circle->mass;
-
-        // Perp Magnitude
-        float FPerpMagnitude = Vector2DotProduct(FGravity, halfspace->getNormal());
-        // Apply Normal Force
-        Vector2 FgPerp = halfspace->getNormal() * FPerpMagnitude;
-        Vector2 FNormal = FgPerp * -1;
-        circle->netForce += FNormal;
-        DrawLineEx(circle->position, circle->position + FNormal, 2, GREEN);
-
-        // Friction
-        // F = uN where u is coefficient of friction between two surfaces
-        float u = circle->coefficientOfFriction;
-        float frictionMagnitude = Vector2Length(FNormal) * u;
-
-        Vector2 FPara = Vector2Rotate(halfspace->getNormal(), -PI * 0.5f);
-
-        float vFPara = Vector2DotProduct(circle->projectileVelo, FPara);
-
-        const float veloctiyThreshold = 5.0f;
-
-        if (fabs(vFPara) > veloctiyThreshold)
-        {
-            Vector2 frictionDirection = (vFPara > 0 ? Vector2Negate(FPara) : FPara);
-            Vector2 Ffriction = frictionDirection * frictionMagnitude;
-            circle->netForce += Ffriction;
-            DrawLineEx(circle->position, circle->position + Ffriction, 2, ORANGE);
-        }
-        else
-        {
-            Vector2 velAlongSurface = FPara * vFPara;
-            circle->projectileVelo -= velAlongSurface;
-        }
-
-        // Bouncing!
-        // From perspective of A
-        //Vector2 velocityBRelativeToA = circleB->projectileVelo - circleA->projectileVelo;
-        float closingVelocity = Vector2DotProduct(circle->projectileVelo, halfspace->getNormal());
-
-        // If is negative then we are colliding. If positive not colliding
-        if (closingVelocity >= 0) return true;
-
-        float restitution = circle->bounciness * halfspace->bounciness;
-        circle->projectileVelo += halfspace->getNormal() * closingVelocity * -(1.0f + restitution);
-        
-        return true;
+        launchAngle = aimSolutions[aimChoice].angle;
+        launchSpeed = aimSolutions[aimChoice].speed;
+        rad = launchAngle * DEG2RAD;
     }
-    else
-        return false;
-}
 
-bool CircleOverlap(PhysicsCircle* circleA, PhysicsCircle* circleB)
-{
-    Vector2 displacement = circleB->position - circleA->position;
-    float distance = Vector2Length(displacement);
-    float sumOfRadii = circleA->radius + circleB->radius;
-
-    float overlapCircle = sumOfRadii - distance;
-
-    if (overlapCircle >= 0)
     {
-        Vector2 normalAtoB;
-        if (abs(distance) < 0.001f)
-        {
-            normalAtoB = { 0, 1 };
-        }
-        else
-        {
-            normalAtoB = displacement / distance;
-        }
-
-        normalAtoB = displacement / distance;
-        Vector2 mtv = normalAtoB * overlapCircle; // minimum translation vector. Shortest distance/direction needed to move circles
-
-        circleA->position -= mtv * 0.5;
-        circleB->position += mtv * 0.5;
-
-        // From perspective of A
-        Vector2 velocityBRelativeToA = circleB->projectileVelo - circleA->projectileVelo;
-        float closingVelocity = Vector2DotProduct(velocityBRelativeToA, normalAtoB);
-
-        // If is negative then we are colliding. If positive not colliding
-        if (closingVelocity >= 0) return true;
-        
-        float restitution = circleA->bounciness * circleB->bounciness;
-
-        float totalMass = circleA->mass + circleB->mass;
-        float impulseMagnitude = ((1.0f + restitution) * closingVelocity * circleA->mass * circleB->mass) / totalMass;
-        // A -->  <-- B
-        Vector2 impulseForB = normalAtoB * -impulseMagnitude;
-        Vector2 impulseForA = normalAtoB * impulseMagnitude;
-
-        // Apply impulse
-        circleA->projectileVelo += impulseForA / circleA->mass;
-        circleB->projectileVelo += impulseForB / circleB->mass;
-
-        return true; // Overlapping
+        PROFILE_ZONE("cleanup");
+        cleanup();
     }
-    else
-        return false; // Not overlapping
-
-    // Overlapping = circleA.radius + circleB.radius - distance
-    // normalize displacement vector and multiply it by overlapping distance
-}
-
-bool BlockOverlap(PhysicsBlock* A, PhysicsBlock* B)
-{
-    Vector2 delta = B->position - A->position;
-
-    float overlapX = (A->halfExtents.x + B->halfExtents.x) - fabsf(delta.x);
-    if (overlapX <= 0) return false;
-
-    float overlapY = (A->halfExtents.y + B->halfExtents.y) - fabsf(delta.y);
-    if (overlapY <= 0) return false;
-
-    Vector2 mtv = { 0, 0 };
-    Vector2 normal = { 0, 0 };
 
-    if (overlapX < overlapY)
+    if (IsKeyPressed(KEY_F5))
     {
-        mtv.x = (delta.x > 0 ? overlapX : -overlapX);
-        normal.x = (delta.x > 0 ? 1.0f : -1.0f);
+        world.saveSnapshot(savedWorld);
+        savedTime = time;
     }
-    else
-    {
-        mtv.y = (delta.y > 0 ? overlapY : -overlapY);
-        normal.y = (delta.y > 0 ? 1.0f : -1.0f);
-    }
-
-    float invA = (A->isStatic || A->mass <= 0.0f) ? 0.0f : 1.0f / A->mass;
-    float invB = (B->isStatic || B->mass <= 0.0f) ? 0.0f : 1.0f / B->mass;
-    float invSum = invA + invB;
 
-    if (invSum > 0.0f)
+    if (IsKeyPressed(KEY_F9) && savedTime >= 0)
     {
-        float shareA = invA / invSum;
-        float shareB = invB / invSum;
-
-        A->position -= mtv * shareA;
-        B->position += mtv * shareB;
+        world.restoreSnapshot(savedWorld);
+        time = savedTime;
+        accumulator = 0;
     }
 
-    Vector2 relVel = B->projectileVelo - A->projectileVelo;
-    float closingVel = Vector2DotProduct(relVel, normal);
-
-    if (closingVel >= 0.0f || invSum <= 0.0f)
-        return true;
-
-    float restitution = A->bounciness * B->bounciness;
-
-    float j = -(1.0f + restitution) * closingVel / invSum;
-    Vector2 impulse = normal * j;
-
-    if (invA > 0.0f)
-        A->projectileVelo -= impulse * invA;
-    if (invB > 0.0f)
-        B->projectileVelo += impulse * invB;
-
-    return true;
-}
-
-
-bool CircleBlockOverlap(PhysicsCircle* C, PhysicsBlock* B)
-{
-    float minX = B->position.x - B->halfExtents.x;
-    float maxX = B->position.x + B->halfExtents.x;
-    float minY = B->position.y - B->halfExtents.y;
-    float maxY = B->position.y + B->halfExtents.y;
-
-    Vector2 closestPoint = {
-        fmaxf(minX, fminf(C->position.x, maxX)),
-        fmaxf(minY, fminf(C->position.y, maxY))
-    };
+    contactsBegunThisFrame = 0;
+    contactsEndedThisFrame = 0;
 
-    Vector2 diff = C->position - closestPoint;
-    float dist = Vector2Length(diff);
+    PROFILE_ZONE("physics");
 
-    Vector2 normal;
-    float overlap;
-
-    if (dist < 0.001f)
-    {
-        float dx = fminf(C->position.x - minX, maxX - C->position.x);
-        float dy = fminf(C->position.y - minY, maxY - C->position.y);
-
-        if (dx < dy) normal = { (C->position.x < B->position.x) ? -1.f : 1.f, 0.f };
-        else         normal = { 0.f, (C->position.y < B->position.y) ? -1.f : 1.f };
-
-        overlap = C->radius + fminf(dx, dy);
-    }
-    else
+    if (lockstep)
     {
-        normal = diff / dist;
-        overlap = C->radius - dist;
-        if (overlap <= 0) return false;
+        step();
+        stepsThisFrame = 1;
+        accumulator = 0;
+        renderAlpha = 1;
+        return;
     }
 
-    Vector2 mtv = normal * overlap;
+    // Fixed timestep: the frame time piles up and physics eats it a whole step at a time,
+    // so a slow frame means more steps rather than one big unstable one
+    accumulator += fminf(frameTime, MAX_FRAME_TIME);
+    stepsThisFrame = 0;
 
-    float invC = (!C->isStatic && C->mass > 0) ? 1.f / C->mass : 0.f;
-    float invB = (!B->isStatic && B->mass > 0) ? 1.f / B->mass : 0.f;
-    float invSum = invC + invB;
-
-    if (invSum > 0)
+    while (accumulator >= dt && stepsThisFrame < MAX_SUBSTEPS)
     {
-        C->position += mtv * (invC / invSum);
-        B->position -= mtv * (invB / invSum);
+        step();
+        accumulator -= dt;
+        stepsThisFrame++;
     }
 
-    Vector2 relVel = C->projectileVelo - B->projectileVelo;
-    float closingVel = Vector2DotProduct(relVel, normal);
-    if (closingVel >= 0) return true;
-
-    float restitution = C->bounciness * B->bounciness;
-    float j = -(1.f + restitution) * closingVel / invSum;
-    Vector2 impulse = normal * j;
+    // Still behind after the cap, drop the rest instead of falling further behind every frame
+    // (the spiral of death). The sim runs slow for a bit but the game keeps responding
+    if (accumulator >= dt)
+        accumulator = fmodf(accumulator, dt);
 
-    if (invC > 0) C->projectileVelo += impulse * invC;
-    if (invB > 0) B->projectileVelo -= impulse * invB;
-
-    return true;
+    // Leftover time is how far we are into the next step, drawing blends towards it
+    renderAlpha = accumulator / dt;
 }
 
-void checkCollisions()
+void spawnAABBTower()
 {
-    //for (int i = 0; i < objects.size(); i++) // Resets all circles to green if not touching
-    //{
-    //    objects[i]->color = GREEN;
-    //}
-
-    for (int i = 0; i < objects.size(); i++) // Overlap check
-    {
-        for (int j = i + 1; j < objects.size(); j++)
-        {
-            PhysicsBody* objectPointerA = objects[i];
-            PhysicsBody* objectPointerB = objects[j];
-
-            PhysicsShape shapeOfA = objectPointerA->Shape();
-            PhysicsShape shapeOfB = objectPointerB->Shape();
-
-            bool didOverlap = false;
-
-            if (shapeOfA == CIRCLE && shapeOfB == CIRCLE)
-            {
-                didOverlap = (CircleOverlap((PhysicsCircle*)objectPointerA, (PhysicsCircle*)objectPointerB));
-            }
-            else if (shapeOfA == CIRCLE && shapeOfB == HALF_SPACE)
-            {
-                didOverlap = (HalfspaceOverlap((PhysicsCircle*)objectPointerA, (PhysicsHalfspace*)objectPointerB));
-            }
-            else if (shapeOfA == HALF_SPACE && shapeOfB == CIRCLE)
-            {
-                didOverlap = (HalfspaceOverlap((PhysicsCircle*)objectPointerB, (PhysicsHalfspace*)objectPointerA));
-            }
-            else if (shapeOfA == BLOCK && shapeOfB == BLOCK)
-            {
-                didOverlap = (BlockOverlap((PhysicsBlock*)objectPointerA, (PhysicsBlock*)objectPointerB));
-            }
-            else if (shapeOfA == BLOCK && shapeOfB == CIRCLE)
-            {
-                didOverlap = (CircleBlockOverlap((PhysicsCircle*)objectPointerB, (PhysicsBlock*)objectPointerA));
-            }
-            else if (shapeOfA == CIRCLE && shapeOfB == BLOCK)
-            {
-                didOverlap = (CircleBlockOverlap((PhysicsCircle*)objectPointerA, (PhysicsBlock*)objectPointerB));
-            }
-
-            if (didOverlap)
-            {
-                //objectPointerA->color = RED;
-                //objectPointerB->color = RED;
-            }
-        }
-    }
-}
+    float x = 800;          // tower horizontal position
+    float baseY = 650;      // height of the ground
+    float blockSize = 30;   // half extents of block
+    int numBlocks = 5;      // height of tower
 
-void cleanup()
-{
-    for (int i = 0; i < objects.size(); i++)
+    for (int i = 0; i < numBlocks; i++)
     {
-        PhysicsBody* obj = objects[i];
-
-        if (obj->isStatic && obj->Shape() == HALF_SPACE) continue;
+        Vector2 halfExtents = { blockSize, blockSize };
 
-        if (obj->Shape() == CIRCLE && (obj->position.y > GetScreenHeight() || IsKeyDown(KEY_BACKSPACE)))
-        {
-            delete obj;
-            objects.erase(objects.begin() + i);
-            i--;
-            continue;
-        }
-
-        if (obj->Shape() == BLOCK && obj->position.y > GetScreenHeight())
-        {
-            delete obj;
-            objects.erase(objects.begin() + i);
-            i--;
-            continue;
-        }
-    }
-}
-
-void addGravityForce()
-{
-    for (int i = 0; i < objects.size(); i++)
-    {
-        if (objects[i]->isStatic) continue;
+        if (i == 0)
+            halfExtents = { blockSize * 10, blockSize };
 
-        Vector2 FGravity = gravityAcceleration * objects[i]->mass; // F = ma therefore Fg = object mass * accleration due to gravity
-        objects[i]->netForce += FGravity;
-    }
-}
+        PhysicsBlock block(&bodies, world.addBlock({ x, baseY - i * (halfExtents.y * 2 + 2) }, halfExtents, 5));
+        block.color() = BROWN;
 
-void resetNetForces()
-{
-    for (int i = 0; i < objects.size(); i++)
-    {
-        objects[i]->netForce = { 0, 0 };
+        if (i == 0)
+            block.setStatic(true);
     }
 }
 
-void addKinematics()
+// One pass per shape type straight over the store. Moving bodies get drawn renderAlpha of the
+// way between their last two physics positions so motion stays smooth at any frame rate.
+// Halfspaces use their real position, the sliders move them between steps
+void drawBodies()
 {
-    // Adds physics to all angry birds created
-    for (int i = 0; i < objects.size(); i++)
+    for (int i = 0; i < bodies.halfspaces.size(); i++)
     {
-        if (objects[i]->isStatic) continue;
-
-        PhysicsCircle* circle = dynamic_cast<PhysicsCircle*>(objects[i]);
-        //if (circle && circle->isTimerActive)
-        //{
-        //    circle->timer += dt;
-        //}
+        Vector2 position = bodies.position[bodies.halfspaceOwner[i]];
+        Vector2 normal = bodies.halfspaces[i].normal;
 
-        objects[i]->position = objects[i]->position + objects[i]->projectileVelo * dt;
-
-        Vector2 acceleration = objects[i]->netForce / objects[i]->mass;
-
-        objects[i]->projectileVelo = objects[i]->projectileVelo + acceleration * dt;
+        DrawCircle(position.x, position.y, 8, RED);
 
-        // Drawing netforces
+        DrawLineEx(position, position + normal * 30, 1, RED);
 
-        DrawLineEx(objects[i]->position, objects[i]->position + objects[i]->netForce, 3, PINK);
+        Vector2 parallelToSurface = Vector2Rotate(normal, PI * 0.5f);
 
-        // Draw gravity force 
-        Vector2 FGravity = gravityAcceleration * objects[i]->mass;
-        DrawLineEx(objects[i]->position, objects[i]->position + FGravity, 2, PURPLE);
+        DrawLineEx(position - parallelToSurface * 2000, position + parallelToSurface * 2000, 1, RED);
     }
-}
-
-void spawnCircle(Vector2 spawnLocation, float mass, float friction, Color color)
-{
-    // Creates and allocates memory for a new circle
-    PhysicsCircle* newCircle = new PhysicsCircle();
-    newCircle->position = spawnLocation;
-    newCircle->mass = mass;
-    newCircle->coefficientOfFriction = friction;
-    newCircle->projectileVelo = velocity;
-    newCircle->color = color;
-    objects.push_back(newCircle);
-    // Adds a new circle to the list
-}
-
-void spawnBlock(Vector2 pos)
-{
-    PhysicsBlock* newBlock = new PhysicsBlock();
-    newBlock->position = pos;
-    newBlock->halfExtents = { 30, 30 };
-    newBlock->color = BLACK;
-    newBlock->mass = circleMass;
-    newBlock->projectileVelo = velocity;
-    objects.push_back(newBlock);
-}
-
-void update()
-{
-    dt = 1.0f / TARGET_FPS;
-    time += dt;
-    rad = launchAngle * DEG2RAD;
-
-    if (IsKeyPressed(KEY_ONE))
-        currentBirdType = 1;
-
-    if (IsKeyPressed(KEY_TWO))
-        currentBirdType = 2;
 
-    // Start Position Movement
-    if (IsKeyDown(KEY_W))
-        launchPos.y -= lpmSpeed * dt;
-    if (IsKeyDown(KEY_S))
-        launchPos.y += lpmSpeed * dt;
-    if (IsKeyDown(KEY_A))
-        launchPos.x -= lpmSpeed * dt;
-    if (IsKeyDown(KEY_D))
-        launchPos.x += lpmSpeed * dt;
-
-    // Spawn launch bird
-    if (IsKeyPressed(KEY_SPACE))
+    for (int i = 0; i < bodies.blocks.size(); i++)
     {
-        if (currentBirdType == 1)
-            spawnCircle(launchPos, circleMass, 0.5f, GREEN);
-        if (currentBirdType == 2)
-            spawnBlock(launchPos);
-    }
+        int body = bodies.blockOwner[i];
+        Vector2 position = bodies.interpolatedPosition(body, renderAlpha);
+        Vector2 halfExtents = bodies.blocks[i].halfExtents;
 
-    resetNetForces();
-
-    addGravityForce();
+        float left = position.x - halfExtents.x;
+        float top = position.y - halfExtents.y;
 
-    checkCollisions();
+        // Sleeping bodies draw a bit faded
+        Color color = bodies.asleep[body] ? Fade(bodies.color[body], 0.6f) : bodies.color[body];
 
-    addKinematics();
+        DrawRectangle(left, top, halfExtents.x * 2, halfExtents.y * 2, color);
 
-    cleanup();
-}
+        DrawRectangleLines(left, top, halfExtents.x * 2, halfExtents.y * 2, BLACK);
 
-void spawnAABBTower()
-{
-    float x = 800;          // tower horizontal position
-    float baseY = 650;      // height of the ground
-    float blockSize = 30;   // half extents of block
-    int numBlocks = 5;      // height of tower
+        DrawText(TextFormat("%.1f", bodies.mass[body]), position.x - 14, position.y - 12, 25, WHITE);
+    }
 
-    for (int i = 0; i < numBlocks; i++)
+    for (int i = 0; i < bodies.circles.size(); i++)
     {
-        PhysicsBlock* block = new PhysicsBlock();
-
-        block->halfExtents = { blockSize, blockSize };
-
-        if (i == 0)
-        {
-            block->halfExtents = { blockSize * 10, blockSize };
-            block->isStatic = true;
-        }
+        int body = bodies.circleOwner[i];
+        Vector2 position = bodies.interpolatedPosition(body, renderAlpha);
 
-        block->position = { x, baseY - i * (block->halfExtents.y * 2 + 2) };
-        block->color = BROWN;
-        block->mass = 5;
-        block->projectileVelo = { 0,0 };
+        Color color = bodies.asleep[body] ? Fade(bodies.color[body], 0.6f) : bodies.color[body];
 
-        objects.push_back(block);
+        DrawCircleV(position, bodies.circles[i].radius, color);
+        DrawText(TextFormat("%.1f", bodies.mass[body]), position.x - 14, position.y - 12, 25, BLACK);
     }
 }
 
-// Displays the world
+// Displays the world. Leaves presenting the frame to EndDrawing so the draw zone doesn't take in
+// the buffer swap and the wait for the target frame rate
 void draw()
 {
+    PROFILE_ZONE("draw");
+
     BeginDrawing();
     ClearBackground(SKYBLUE);
 
+    // Debug lines from the last physics step under everything else
+    debugDraw.flush();
+
     // Variable Adjustment Sliders
     GuiSliderBar(Rectangle{ 10, 150, 700, 20 }, "", TextFormat("Angle: %.2f", launchAngle), &launchAngle, 0, 180);
     GuiSliderBar(Rectangle{ 10, 190, 700, 20 }, "", TextFormat("Speed: %.2f", launchSpeed), &launchSpeed, 0, 500);
+    Vector2 oldGravity = gravityAcceleration;
     GuiSliderBar(Rectangle{ 10, 230, 700, 20 }, "", TextFormat("Gravity: %.2f", gravityAcceleration.y), &gravityAcceleration.y, -350, 700);
     // Halfspace Sliders
-    GuiSliderBar(Rectangle{ 80, 270, 700, 20 }, "Halfspace X", TextFormat("%.0f", halfspace.position.x), &halfspace.position.x, 0, GetScreenWidth());
-    GuiSliderBar(Rectangle{ 80, 310, 700, 20 }, "Halfspace y", TextFormat("%.0f", halfspace.position.y), &halfspace.position.y, 0, GetScreenHeight());
+    Vector2 oldHalfspacePosition = halfspace.position();
+    GuiSliderBar(Rectangle{ 80, 270, 700, 20 }, "Halfspace X", TextFormat("%.0f", halfspace.position().x), &halfspace.position().x, 0, GetScreenWidth());
+    GuiSliderBar(Rectangle{ 80, 310, 700, 20 }, "Halfspace y", TextFormat("%.0f", halfspace.position().y), &halfspace.position().y, 0, GetScreenHeight());
     float halfspaceRotation = halfspace.getRotation();
+    float oldHalfspaceRotation = halfspaceRotation;
     GuiSliderBar(Rectangle{ 110, 350, 500, 20 }, "Halfspace Rotate", TextFormat("%.0f", halfspaceRotation), &halfspaceRotation, -180, 180);
     halfspace.setRotationDegrees(halfspaceRotation);
+    // Moving the ground or changing gravity pulls the floor out from under sleeping bodies
+    if (!Vector2Equals(oldHalfspacePosition, halfspace.position()) || oldHalfspaceRotation != halfspaceRotation ||
+        !Vector2Equals(oldGravity, gravityAcceleration))
+        bodies.wakeAll();
     //Friction Control (Might use later idk)
     //GuiSliderBar(Rectangle{ 110, 390, 500, 20 }, "Friction Control", TextFormat("%.1f", coefficientOfFriction), &coefficientOfFriction, 0, 1);
     GuiSliderBar(Rectangle{ 900, 150, 250, 20 }, "Circle Mass", TextFormat("%.1f", circleMass), &circleMass, 1, 10);
+    // Broadphase picker
+    int broadphaseChoice = world.broadphaseMode;
+    GuiToggleGroup(Rectangle{ 900, 190, 61, 20 }, "Brute;Grid;SAP;Tree", &broadphaseChoice);
+    world.broadphaseMode = (BroadphaseMode)broadphaseChoice;
+    // Solver iterations
+    float iterations = world.solver.velocityIterations;
+    GuiSliderBar(Rectangle{ 900, 230, 250, 20 }, "Iterations", TextFormat("%i", world.solver.velocityIterations), &iterations, 1, 30);
+    world.solver.velocityIterations = (int)iterations;
+    // Debug draw categories
+    debugCategoryToggle(270, "Forces", DEBUG_FORCES);
+    debugCategoryToggle(300, "Contact forces", DEBUG_CONTACT_FORCES);
+    debugCategoryToggle(330, "Contacts", DEBUG_CONTACTS);
+    debugCategoryToggle(360, "AABBs", DEBUG_AABBS);
+    GuiCheckBox(Rectangle{ 900, 400, 20, 20 }, "Bullet birds", &bulletBirds);
 
     // Text Box
     DrawRectangle(10, 30, 280, 100, BLACK);
@@ -644,8 +363,35 @@ void draw()
     velocity = { launchSpeed * cosf(rad), -launchSpeed * sinf(rad) };
     // Creating Line
     DrawLineEx(launchPos, Vector2{ launchPos + velocity }, 7, RED);
+    // Where the aim line first touches something
+    Vector2 aimHit;
+    if (world.raycast(launchPos, velocity, &aimHit) >= 0)
+        DrawCircleV(aimHit, 6, YELLOW);
+    // Predicted flight of a circle launched now, up to where it first touches something
+    TrajectoryHit predicted;
+    {
+        PROFILE_ZONE("trajectory");
+        predicted = PredictTrajectory(world, launchPos, velocity, 30.0f, dt, 10.0f, &predictedPath);
+    }
+    for (int i = 1; i < predictedPath.size(); i += 2)
+        DrawLineEx(predictedPath[i - 1], predictedPath[i], 2, WHITE);
+    if (predicted.body >= 0)
+    {
+        DrawCircleLinesV(predicted.position, 30.0f, WHITE);
+        DrawCircleV(predicted.point, 6, ORANGE);
+        DrawText(TextFormat("Hits body %i after %.2f s", predicted.body, predicted.time), 10, 680, 30, WHITE);
+    }
     // Number of Circles Spawned Text
-    DrawText(TextFormat("Projectiles: %i", objects.size() - 1), 10, 400, 30, WHITE);
+    DrawText(TextFormat("Projectiles: %i", bodies.size() - 1), 10, 400, 30, WHITE);
+    DrawText(TextFormat("Pairs tested: %i  Overlapping: %i", world.getStats().pairsTested, world.getStats().pairsOverlapping), 10, 440, 30, WHITE);
+    DrawText(TextFormat("Islands: %i  Sleeping: %i  Touching: %i (+%i -%i)", world.islands.getIslandCount(), world.islands.getSleepingCount(),
+        world.getPairCache().getPairCount(), contactsBegunThisFrame, contactsEndedThisFrame), 10, 520, 30, WHITE);
+    DrawText(TextFormat("FPS: %i  Physics steps this frame: %i", GetFPS(), stepsThisFrame), 10, 560, 30, WHITE);
+    if (lockstep)
+        DrawText(TextFormat("Lockstep  step %i  hash %016llx", world.getStepCount(), (unsigned long long)world.getRollingHash()), 10, 600, 30, WHITE);
+    else
+        DrawText("L for lockstep", 10, 600, 30, WHITE);
+    DrawText(savedTime >= 0 ? TextFormat("F5 snapshot  F9 back to %.1f s", savedTime) : "F5 snapshot", 10, 640, 30, WHITE);
     // Text (In the text box)
     DrawText("Launch Position", 32, 42, 30, WHITE);
     DrawText(TextFormat("(%.0f, %.0f)", launchPos.x, launchPos.y), 32, 82, 30, WHITE);
@@ -657,11 +403,36 @@ void draw()
     DrawText(TextFormat("(%.1f)", gravityAcceleration.y), 925, 82, 30, WHITE);
     // Start Position
     DrawCircleV(launchPos, 10, RED);
-    // Draws each circle in list
-    for (int i = 0; i < objects.size(); i++)
+    // Draws every body
+    drawBodies();
+
+    int picked = bodies.indexOf(pickedBody);
+    if (picked >= 0)
+    {
+        AABB box = bodies.getAABB(picked);
+        DrawRectangleLinesEx(Rectangle{ box.min.x, box.min.y, box.max.x - box.min.x, box.max.y - box.min.y }, 3, YELLOW);
+        DrawText(TextFormat("Picked: mass %.1f  speed %.0f%s  (F to kick)", bodies.mass[picked], Vector2Length(bodies.velocity[picked]),
+            bodies.asleep[picked] ? "  asleep" : ""), 10, 480, 30, WHITE);
+    }
+
+    // Launches that would hit the picked block, redone every frame so they follow the sliders and the tower
+    if (picked >= 0 && bodies.shape[picked] == BLOCK)
     {
-        objects[i]->draw();
+        PROFILE_ZONE("aim solver");
+        SolveAim(world, launchPos, 30.0f, picked, 50, 500, 46, dt, 10.0f, aimSolutions);
     }
+    else
+        aimSolutions.clear();
+    // Shooting downwards is off the slider
+    aimChoice = -1;
+    for (int i = 0; i < aimSolutions.size() && aimChoice < 0; i++)
+    {
+        if (aimSolutions[i].angle <= 180)
+            aimChoice = i;
+    }
+    if (aimChoice >= 0)
+        DrawText(TextFormat("%i ways to hit it, T for %.1f degrees at %.0f", (int)aimSolutions.size(), aimSolutions[aimChoice].angle,
+            aimSolutions[aimChoice].speed), 10, 720, 30, WHITE);
 
     // Draw Free Body Diagram
     //Vector2 location = { (InitialWidth / 2), (InitialHeight / 2)};
@@ -679,17 +450,29 @@ void draw()
     //Vector2 Ffriction = FgPara * -1;
     //DrawLineEx(location, location + Ffriction, 3, ORANGE);
 
-    EndDrawing();
+    if (showProfiler)
+        DrawProfileOverlay(profiler, Rectangle{ 590, 440, 600, 320 }, "trace.json");
+    else
+        DrawText("P for profiler", 10, 760, 30, WHITE);
+#if ENGINE_COUNTERS
+    if (showCounters)
+        DrawEngineCounters(counters, Rectangle{ 590, 320, 600, 115 });
+    else
+        DrawText("C for counters", 300, 760, 30, WHITE);
+#endif
+
+    // Everything still batched goes to the GPU inside the zone rather than in EndDrawing
+    rlDrawRenderBatchActive();
 }
 
 int main()
 {
     InitWindow(InitialWidth, InitialHeight, "Lucas Adda 101566961 2005 Week 15");
     SetTargetFPS(TARGET_FPS);
-    halfspace.isStatic = true;
-    halfspace.id = 1;
-    halfspace.position = { 600, 700 };
-    objects.push_back(&halfspace);
+    world.jobs = &jobs;
+    world.debugDraw = &debugDraw;
+    profilingEnabled = true;
+    halfspace = PhysicsHalfspace(&bodies, world.addHalfspace({ 600, 700 }, 0));
 
     spawnAABBTower();
 
@@ -699,10 +482,24 @@ int main()
 
     while (!WindowShouldClose()) // Loops TARGET_FPS per second
     {
-        update();
+        {
+            PROFILE_ZONE("update");
+            update();
+        }
+#if ENGINE_COUNTERS
+        GatherPhysicsCounters(world, stepsThisFrame, counters);
+#endif
         draw();
+        {
+            PROFILE_ZONE("present");
+            EndDrawing();
+        }
+#if ENGINE_COUNTERS
+        GatherRenderCounters(counters);
+#endif
+        profiler.endFrame();
     }
 
     CloseWindow();
     return 0;
-}
\ No newline at end of file
+}
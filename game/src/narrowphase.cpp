@@ -0,0 +1,380 @@
+#include "narrowphase.h"
+#include "bodystore.h"
+#include "jobs.h"
+#include <cmath>
+
+// Pairs get gathered this many at a time so the flat arrays stay in L1
+static const int chunkSize = 64;
+
+// Circles closer than this get pushed straight down, same as CircleOverlap used to
+static const float degenerateDistance = 0.001f;
+
+struct CircleChunk
+{
+    alignas(32) float ax[chunkSize];
+    alignas(32) float ay[chunkSize];
+    alignas(32) float bx[chunkSize];
+    alignas(32) float by[chunkSize];
+    alignas(32) float radiusA[chunkSize];
+    alignas(32) float radiusSum[chunkSize];
+    int a[chunkSize];
+    int b[chunkSize];
+};
+
+// Fills the chunk with pairs [first, first + count) and pads it out to a multiple of 8
+// with lanes that can never touch, so the kernels don't need a tail loop
+static int gatherChunk(const BodyStore& bodies, const std::vector<BroadphasePair>& pairs, int first, int count, CircleChunk& chunk)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int a = pairs[first + i].a;
+        int b = pairs[first + i].b;
+        float radiusA = bodies.circles[bodies.shapeIndex[a]].radius;
+        float radiusB = bodies.circles[bodies.shapeIndex[b]].radius;
+
+        chunk.a[i] = a;
+        chunk.b[i] = b;
+        chunk.ax[i] = bodies.position[a].x;
+        chunk.ay[i] = bodies.position[a].y;
+        chunk.bx[i] = bodies.position[b].x;
+        chunk.by[i] = bodies.position[b].y;
+        chunk.radiusA[i] = radiusA;
+        chunk.radiusSum[i] = radiusA + radiusB;
+    }
+
+    int padded = (count + 7) & ~7;
+
+    for (int i = count; i < padded; i++)
+    {
+        chunk.a[i] = chunk.b[i] = -1;
+        chunk.ax[i] = chunk.ay[i] = chunk.bx[i] = chunk.by[i] = 0.0f;
+        chunk.radiusA[i] = 0.0f;
+        chunk.radiusSum[i] = -1.0f;
+    }
+
+    return padded;
+}
+
+// Every pair gets written and the count only moves on for touching ones, that keeps
+// the compaction free of unpredictable branches. out needs room for the whole chunk
+static void writeContact(const CircleChunk& chunk, int i, float nx, float ny, float px, float py, float penetration, Contact& out)
+{
+    out.a = chunk.a[i];
+    out.b = chunk.b[i];
+    out.normal = { nx, ny };
+    out.point = { px, py };
+    out.penetration = penetration;
+}
+
+// Same operations in the same order as the SIMD kernels so they all agree bit for bit
+static int circlesScalar(const CircleChunk& chunk, int count, Contact* out)
+{
+    int written = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        float dx = chunk.bx[i] - chunk.ax[i];
+        float dy = chunk.by[i] - chunk.ay[i];
+        float distance = sqrtf(dx * dx + dy * dy);
+        float penetration = chunk.radiusSum[i] - distance;
+
+        float inv = 1.0f / distance;
+        float nx = (distance < degenerateDistance) ? 0.0f : dx * inv;
+        float ny = (distance < degenerateDistance) ? 1.0f : dy * inv;
+        float reach = chunk.radiusA[i] - penetration * 0.5f;
+
+        writeContact(chunk, i, nx, ny, chunk.ax[i] + nx * reach, chunk.ay[i] + ny * reach, penetration, out[written]);
+
+        // NaN fails this too so broken bodies never make contacts
+        written += (penetration >= 0.0f) ? 1 : 0;
+    }
+
+    return written;
+}
+
+#if SIMD_X64
+
+static int circlesSSE(const CircleChunk& chunk, int count, Contact* out)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 tiny = _mm_set1_ps(degenerateDistance);
+
+    int written = 0;
+
+    for (int i = 0; i < count; i += 4)
+    {
+        __m128 ax = _mm_load_ps(chunk.ax + i);
+        __m128 ay = _mm_load_ps(chunk.ay + i);
+        __m128 dx = _mm_sub_ps(_mm_load_ps(chunk.bx + i), ax);
+        __m128 dy = _mm_sub_ps(_mm_load_ps(chunk.by + i), ay);
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 penetration = _mm_sub_ps(_mm_load_ps(chunk.radiusSum + i), distance);
+
+        int touching = _mm_movemask_ps(_mm_cmpge_ps(penetration, zero));
+        if (touching == 0) continue;
+
+        // Overlapping centers get { 0, 1 } picked per lane instead of branching
+        __m128 inv = _mm_div_ps(one, distance);
+        __m128 degenerate = _mm_cmplt_ps(distance, tiny);
+        __m128 nx = _mm_or_ps(_mm_and_ps(degenerate, zero), _mm_andnot_ps(degenerate, _mm_mul_ps(dx, inv)));
+        __m128 ny = _mm_or_ps(_mm_and_ps(degenerate, one), _mm_andnot_ps(degenerate, _mm_mul_ps(dy, inv)));
+        __m128 reach = _mm_sub_ps(_mm_load_ps(chunk.radiusA + i), _mm_mul_ps(penetration, half));
+
+        alignas(16) float lanes[5][4];
+        _mm_store_ps(lanes[0], nx);
+        _mm_store_ps(lanes[1], ny);
+        _mm_store_ps(lanes[2], _mm_add_ps(ax, _mm_mul_ps(nx, reach)));
+        _mm_store_ps(lanes[3], _mm_add_ps(ay, _mm_mul_ps(ny, reach)));
+        _mm_store_ps(lanes[4], penetration);
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            writeContact(chunk, i + lane, lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane], lanes[4][lane], out[written]);
+            written += (touching >> lane) & 1;
+        }
+    }
+
+    return written;
+}
+
+SIMD_AVX2_TARGET
+static int circlesAVX2(const CircleChunk& chunk, int count, Contact* out)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 tiny = _mm256_set1_ps(degenerateDistance);
+
+    int written = 0;
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256 ax = _mm256_load_ps(chunk.ax + i);
+        __m256 ay = _mm256_load_ps(chunk.ay + i);
+        __m256 dx = _mm256_sub_ps(_mm256_load_ps(chunk.bx + i), ax);
+        __m256 dy = _mm256_sub_ps(_mm256_load_ps(chunk.by + i), ay);
+        __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 penetration = _mm256_sub_ps(_mm256_load_ps(chunk.radiusSum + i), distance);
+
+        int touching = _mm256_movemask_ps(_mm256_cmp_ps(penetration, zero, _CMP_GE_OQ));
+        if (touching == 0) continue;
+
+        __m256 inv = _mm256_div_ps(one, distance);
+        __m256 degenerate = _mm256_cmp_ps(distance, tiny, _CMP_LT_OQ);
+        __m256 nx = _mm256_blendv_ps(_mm256_mul_ps(dx, inv), zero, degenerate);
+        __m256 ny = _mm256_blendv_ps(_mm256_mul_ps(dy, inv), one, degenerate);
+        __m256 reach = _mm256_sub_ps(_mm256_load_ps(chunk.radiusA + i), _mm256_mul_ps(penetration, half));
+
+        alignas(32) float lanes[5][8];
+        _mm256_store_ps(lanes[0], nx);
+        _mm256_store_ps(lanes[1], ny);
+        _mm256_store_ps(lanes[2], _mm256_add_ps(ax, _mm256_mul_ps(nx, reach)));
+        _mm256_store_ps(lanes[3], _mm256_add_ps(ay, _mm256_mul_ps(ny, reach)));
+        _mm256_store_ps(lanes[4], penetration);
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            writeContact(chunk, i + lane, lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane], lanes[4][lane], out[written]);
+            written += (touching >> lane) & 1;
+        }
+    }
+
+    return written;
+}
+
+#endif
+
+void FindCircleContacts(const BodyStore& bodies, const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts, SimdLevel level)
+{
+    if (!SimdLevelSupported(level)) level = BestSimdLevel();
+
+    CircleChunk chunk;
+    int written = (int)contacts.size();
+
+    for (int first = 0; first < pairs.size(); first += chunkSize)
+    {
+        int count = (int)pairs.size() - first;
+        if (count > chunkSize) count = chunkSize;
+
+        int padded = gatherChunk(bodies, pairs, first, count, chunk);
+
+        // Room for every pair in the chunk, trimmed back at the end
+        if (contacts.size() < written + padded) contacts.resize(written + padded);
+        Contact* out = contacts.data() + written;
+
+        switch (level)
+        {
+#if SIMD_X64
+        case SIMD_AVX2: written += circlesAVX2(chunk, padded, out); break;
+        case SIMD_SSE: written += circlesSSE(chunk, padded, out); break;
+#endif
+        default: written += circlesScalar(chunk, padded, out); break;
+        }
+    }
+
+    contacts.resize(written);
+}
+
+// One contact for a single pair, false if they aren't touching. contact.a and contact.b come out
+// in the order the bodies were passed in. Each one only gets called from its batch loop, where it's inlined
+
+// Pushes out along whichever axis overlaps the least
+static bool blockBlockContact(const BodyStore& bodies, int blockA, int blockB, Contact& contact)
+{
+    Vector2 halfA = bodies.blocks[bodies.shapeIndex[blockA]].halfExtents;
+    Vector2 halfB = bodies.blocks[bodies.shapeIndex[blockB]].halfExtents;
+    Vector2 positionA = bodies.position[blockA];
+    Vector2 positionB = bodies.position[blockB];
+    float dx = positionB.x - positionA.x;
+    float dy = positionB.y - positionA.y;
+
+    float overlapX = (halfA.x + halfB.x) - fabsf(dx);
+    if (!(overlapX > 0)) return false;
+
+    float overlapY = (halfA.y + halfB.y) - fabsf(dy);
+    if (!(overlapY > 0)) return false;
+
+    contact.a = blockA;
+    contact.b = blockB;
+
+    if (overlapX < overlapY)
+    {
+        contact.normal = { dx > 0 ? 1.0f : -1.0f, 0.0f };
+        contact.penetration = overlapX;
+    }
+    else
+    {
+        contact.normal = { 0.0f, dy > 0 ? 1.0f : -1.0f };
+        contact.penetration = overlapY;
+    }
+
+    // Middle of the overlapping rectangle
+    float left = fmaxf(positionA.x - halfA.x, positionB.x - halfB.x);
+    float right = fminf(positionA.x + halfA.x, positionB.x + halfB.x);
+    float top = fmaxf(positionA.y - halfA.y, positionB.y - halfB.y);
+    float bottom = fminf(positionA.y + halfA.y, positionB.y + halfB.y);
+    contact.point = { (left + right) * 0.5f, (top + bottom) * 0.5f };
+    return true;
+}
+
+static bool circleBlockContact(const BodyStore& bodies, int circle, int block, Contact& contact)
+{
+    Vector2 circlePosition = bodies.position[circle];
+    Vector2 blockPosition = bodies.position[block];
+    Vector2 halfExtents = bodies.blocks[bodies.shapeIndex[block]].halfExtents;
+    float radius = bodies.circles[bodies.shapeIndex[circle]].radius;
+
+    float minX = blockPosition.x - halfExtents.x;
+    float maxX = blockPosition.x + halfExtents.x;
+    float minY = blockPosition.y - halfExtents.y;
+    float maxY = blockPosition.y + halfExtents.y;
+
+    Vector2 closestPoint = {
+        fmaxf(minX, fminf(circlePosition.x, maxX)),
+        fmaxf(minY, fminf(circlePosition.y, maxY))
+    };
+
+    float diffX = circlePosition.x - closestPoint.x;
+    float diffY = circlePosition.y - closestPoint.y;
+    float distance = sqrtf(diffX * diffX + diffY * diffY);
+
+    // Normal from the block out to the circle
+    Vector2 normal;
+    float penetration;
+
+    if (distance < degenerateDistance)
+    {
+        // Center inside the block, push out through the nearest side
+        float distanceX = fminf(circlePosition.x - minX, maxX - circlePosition.x);
+        float distanceY = fminf(circlePosition.y - minY, maxY - circlePosition.y);
+
+        if (distanceX < distanceY) normal = { (circlePosition.x < blockPosition.x) ? -1.0f : 1.0f, 0.0f };
+        else                       normal = { 0.0f, (circlePosition.y < blockPosition.y) ? -1.0f : 1.0f };
+
+        penetration = radius + fminf(distanceX, distanceY);
+    }
+    else
+    {
+        normal = { diffX / distance, diffY / distance };
+        penetration = radius - distance;
+        if (!(penetration > 0)) return false;
+    }
+
+    contact.a = circle;
+    contact.b = block;
+    contact.normal = { -normal.x, -normal.y };
+    contact.point = { circlePosition.x - normal.x * (radius - penetration * 0.5f), circlePosition.y - normal.y * (radius - penetration * 0.5f) };
+    contact.penetration = penetration;
+    return true;
+}
+
+void FlipContact(Contact& contact)
+{
+    int a = contact.a;
+    contact.a = contact.b;
+    contact.b = a;
+    contact.normal = { -contact.normal.x, -contact.normal.y };
+}
+
+// One contact function over a whole batch. The function is a template argument so it gets
+// inlined into the loop, no call per pair. Contacts get flipped back so a is always the lower index
+typedef bool (*PairContactFunction)(const BodyStore& bodies, int first, int second, Contact& contact);
+
+template <PairContactFunction findContact>
+static void runBatch(const BodyStore& bodies, const std::vector<BroadphasePair>& batch, std::vector<Contact>& contacts)
+{
+    for (int i = 0; i < batch.size(); i++)
+    {
+        Contact contact;
+        if (!findContact(bodies, batch[i].a, batch[i].b, contact)) continue;
+
+        if (contact.a > contact.b) FlipContact(contact);
+        contacts.push_back(contact);
+    }
+}
+
+void NarrowPhase::findContacts(const BodyStore& bodies, const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts,
+    BroadphaseStats& stats, JobSystem* jobs)
+{
+    const int grainSize = 1024;
+    int chunkCount = JobChunkCount((int)pairs.size(), grainSize);
+    if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+
+    ParallelFor(jobs, (int)pairs.size(), grainSize, [&](int begin, int end, int chunkIndex)
+    {
+        ChunkResult& chunk = chunks[chunkIndex];
+        for (int r = 0; r < CONTACT_ROUTINE_COUNT; r++) chunk.batches[r].clear();
+        chunk.contacts.clear();
+
+        for (int p = begin; p < end; p++)
+        {
+            int a = pairs[p].a;
+            int b = pairs[p].b;
+
+            // Sleeping and static bodies resting on each other, the solver keeps their old contact
+            if (!bodies.isAwake(a) && !bodies.isAwake(b)) continue;
+
+            ContactDispatch dispatch = contactDispatch.cell[bodies.shape[a]][bodies.shape[b]];
+            chunk.batches[dispatch.routine].push_back(dispatch.flip ? BroadphasePair{ b, a } : pairs[p]);
+        }
+
+        FindCircleContacts(bodies, chunk.batches[CONTACT_CIRCLE_CIRCLE], chunk.contacts);
+        runBatch<circleBlockContact>(bodies, chunk.batches[CONTACT_CIRCLE_BLOCK], chunk.contacts);
+        runBatch<blockBlockContact>(bodies, chunk.batches[CONTACT_BLOCK_BLOCK], chunk.contacts);
+
+        // The halfspace batches stay empty, halfspaces have empty boxes and no broadphase pairs them
+        chunk.pairsTested = (int)(chunk.batches[CONTACT_CIRCLE_CIRCLE].size() + chunk.batches[CONTACT_CIRCLE_BLOCK].size() +
+            chunk.batches[CONTACT_BLOCK_BLOCK].size());
+    });
+
+    stats = {};
+
+    for (int i = 0; i < chunkCount; i++)
+    {
+        contacts.insert(contacts.end(), chunks[i].contacts.begin(), chunks[i].contacts.end());
+        stats.pairsTested += chunks[i].pairsTested;
+        stats.pairsOverlapping += (int)chunks[i].contacts.size();
+    }
+}
@@ -0,0 +1,172 @@
+#include "paircache.h"
+#include "snapshot.h"
+#include "solver.h"
+#include <algorithm>
+
+static const int initialCapacity = 64;
+
+static uint64_t hashKey(uint64_t key)
+{
+    key *= 0x9E3779B97F4A7C15ull;
+    return key ^ (key >> 32);
+}
+
+// Lower slot in the high half so the key's the same whichever way round the pair comes.
+// The two slots are never equal, so a real key is never 0
+uint64_t PairCache::makeKey(BodyHandle a, BodyHandle b)
+{
+    uint64_t low = (uint64_t)(a.slot < b.slot ? a.slot : b.slot);
+    uint64_t high = (uint64_t)(a.slot < b.slot ? b.slot : a.slot);
+    return (low << 32) | high;
+}
+
+int PairCache::findSlot(uint64_t key) const
+{
+    int mask = (int)entries.size() - 1;
+    int slot = (int)(hashKey(key) & mask);
+
+    while (entries[slot].key != 0 && entries[slot].key != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+// Backward shift instead of tombstones: later entries in the same run move up into the
+// gap unless the gap is before where they hash to
+void PairCache::erase(int slot)
+{
+    int mask = (int)entries.size() - 1;
+    int gap = slot;
+    entries[gap].key = 0;
+
+    for (int next = (gap + 1) & mask; entries[next].key != 0; next = (next + 1) & mask)
+    {
+        int home = (int)(hashKey(entries[next].key) & mask);
+        bool homeAfterGap = (gap <= next) ? (gap < home && home <= next) : (gap < home || home <= next);
+        if (homeAfterGap) continue;
+
+        entries[gap] = entries[next];
+        entries[next].key = 0;
+        gap = next;
+    }
+
+    pairCount--;
+}
+
+void PairCache::grow()
+{
+    std::vector<Entry> old;
+    old.swap(entries);
+
+    entries.resize(old.empty() ? initialCapacity : old.size() * 2);
+    for (int i = 0; i < entries.size(); i++) entries[i].key = 0;
+
+    for (int i = 0; i < old.size(); i++)
+    {
+        if (old[i].key != 0) entries[findSlot(old[i].key)] = old[i];
+    }
+}
+
+ContactEvent PairCache::makeEvent(const BodyStore& bodies, const Entry& entry) const
+{
+    return { entry.handleA, entry.handleB, bodies.indexOf(entry.handleA), bodies.indexOf(entry.handleB), entry.routine, entry.age,
+        entry.normal, entry.point, entry.normalImpulse };
+}
+
+void PairCache::update(const BodyStore& bodies, const std::vector<ContactManifold>& manifolds)
+{
+    updateCount++;
+    beginEvents.clear();
+    persistEvents.clear();
+    endEvents.clear();
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        const ContactManifold& manifold = manifolds[i];
+        BodyHandle handleA = bodies.getHandle(manifold.a);
+        BodyHandle handleB = bodies.getHandle(manifold.b);
+        uint64_t key = makeKey(handleA, handleB);
+
+        if ((pairCount + 1) * 2 > (int)entries.size()) grow();
+
+        Entry& entry = entries[findSlot(key)];
+        bool isNew = entry.key != key;
+
+        // Same slots but a different generation: one of the bodies was removed and its
+        // handle slot went to a new body, which is a different pair altogether
+        if (!isNew && !((entry.handleA == handleA && entry.handleB == handleB) || (entry.handleA == handleB && entry.handleB == handleA)))
+        {
+            entry.normalImpulse = 0;
+            endEvents.push_back(makeEvent(bodies, entry));
+            isNew = true;
+        }
+
+        if (isNew)
+        {
+            if (entry.key != key) pairCount++;
+            entry.key = key;
+            entry.routine = ContactRoutineFor(bodies.shape[manifold.a], bodies.shape[manifold.b]);
+            entry.age = 0;
+        }
+        else
+        {
+            entry.age++;
+        }
+
+        entry.handleA = handleA;
+        entry.handleB = handleB;
+        entry.lastUpdate = updateCount;
+        entry.normal = manifold.normal;
+        entry.point = manifold.point;
+        entry.normalImpulse = manifold.normalImpulse;
+
+        (isNew ? beginEvents : persistEvents).push_back(makeEvent(bodies, entry));
+    }
+
+    // Anything not touched this update has stopped touching, or lost a body
+    endedKeys.clear();
+
+    for (int i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].key != 0 && entries[i].lastUpdate != updateCount) endedKeys.push_back(entries[i].key);
+    }
+
+    std::sort(endedKeys.begin(), endedKeys.end());
+
+    for (int i = 0; i < endedKeys.size(); i++)
+    {
+        int slot = findSlot(endedKeys[i]);
+        entries[slot].normalImpulse = 0;
+        endEvents.push_back(makeEvent(bodies, entries[slot]));
+        erase(slot);
+    }
+}
+
+void PairCache::clear()
+{
+    entries.clear();
+    pairCount = 0;
+    beginEvents.clear();
+    persistEvents.clear();
+    endEvents.clear();
+}
+
+void PairCache::save(SnapshotWriter& writer) const
+{
+    writer.array(entries);
+    writer.value(pairCount);
+    writer.value(updateCount);
+}
+
+void PairCache::restore(SnapshotReader& reader)
+{
+    reader.array(entries);
+    reader.value(pairCount);
+    reader.value(updateCount);
+
+    beginEvents.clear();
+    persistEvents.clear();
+    endEvents.clear();
+}
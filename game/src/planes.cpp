@@ -0,0 +1,289 @@
+#include "planes.h"
+#include "jobs.h"
+#include <cmath>
+
+// Bodies get gathered this many at a time so the flat arrays stay in L1
+static const int chunkSize = 64;
+
+struct BodyChunk
+{
+    alignas(32) float x[chunkSize];
+    alignas(32) float y[chunkSize];
+    alignas(32) float radius[chunkSize]; // 0 for blocks
+    alignas(32) float halfX[chunkSize]; // 0 for circles
+    alignas(32) float halfY[chunkSize];
+    int body[chunkSize];
+};
+
+// Fills the chunk with awake circles and blocks from [*next, end), moving *next past the last
+// one taken. Pads out to a multiple of 8 with lanes that can't reach any plane
+static int gatherChunk(const BodyStore& bodies, int* next, int end, BodyChunk& chunk, int* count)
+{
+    int taken = 0;
+    int i = *next;
+
+    for (; i < end && taken < chunkSize; i++)
+    {
+        if (bodies.shape[i] == HALF_SPACE || !bodies.isAwake(i)) continue;
+
+        chunk.body[taken] = i;
+        chunk.x[taken] = bodies.position[i].x;
+        chunk.y[taken] = bodies.position[i].y;
+
+        if (bodies.shape[i] == CIRCLE)
+        {
+            chunk.radius[taken] = bodies.circles[bodies.shapeIndex[i]].radius;
+            chunk.halfX[taken] = chunk.halfY[taken] = 0.0f;
+        }
+        else
+        {
+            chunk.radius[taken] = 0.0f;
+            chunk.halfX[taken] = bodies.blocks[bodies.shapeIndex[i]].halfExtents.x;
+            chunk.halfY[taken] = bodies.blocks[bodies.shapeIndex[i]].halfExtents.y;
+        }
+
+        taken++;
+    }
+
+    *next = i;
+    *count = taken;
+
+    int padded = (taken + 7) & ~7;
+
+    for (int lane = taken; lane < padded; lane++)
+    {
+        chunk.body[lane] = -1;
+        chunk.x[lane] = chunk.y[lane] = 0.0f;
+        chunk.radius[lane] = -INFINITY;
+        chunk.halfX[lane] = chunk.halfY[lane] = 0.0f;
+    }
+
+    return padded;
+}
+
+// Same pair order as the narrowphase: lower index first, normal from a to b.
+// The plane's normal points out towards the body
+static void writeContact(const BodyChunk& chunk, int lane, const PlanePass::PlaneList& planes, int plane,
+    float pointX, float pointY, float penetration, Contact& out)
+{
+    int body = chunk.body[lane];
+    int planeBody = planes.body[plane];
+    float side = (body < planeBody) ? -1.0f : 1.0f;
+
+    out.a = (body < planeBody) ? body : planeBody;
+    out.b = (body < planeBody) ? planeBody : body;
+    out.normal = { planes.normalX[plane] * side, planes.normalY[plane] * side };
+    out.point = { pointX, pointY };
+    out.penetration = penetration;
+}
+
+// Same operations in the same order as the SIMD kernels so they all agree bit for bit.
+// Every kernel goes 8 bodies against one plane at a time, so contacts come out in the same order too.
+// For a circle reach is just its radius, so circles get the same contacts they got as narrowphase pairs
+static int planesScalar(const BodyChunk& chunk, int count, const PlanePass::PlaneList& planes, std::vector<Contact>& out, int written)
+{
+    for (int i = 0; i < count; i += 8)
+    {
+        for (int p = 0; p < planes.body.size(); p++)
+        {
+            float nx = planes.normalX[p];
+            float ny = planes.normalY[p];
+
+            for (int lane = i; lane < i + 8; lane++)
+            {
+                // How far the body reaches towards the plane from its center
+                float reach = chunk.radius[lane] + fabsf(nx) * chunk.halfX[lane] + fabsf(ny) * chunk.halfY[lane];
+                float distance = (chunk.x[lane] - planes.x[p]) * nx + (chunk.y[lane] - planes.y[p]) * ny;
+                float penetration = reach - distance;
+
+                // NaN fails this too so broken bodies never make contacts
+                if (!(penetration > 0)) continue;
+
+                // Halfway between the plane and the deepest point, under the body's center
+                float inner = reach - penetration * 0.5f;
+
+                if (out.size() < written + 1) out.resize(written + 1);
+                writeContact(chunk, lane, planes, p, chunk.x[lane] - nx * inner, chunk.y[lane] - ny * inner, penetration, out[written]);
+                written++;
+            }
+        }
+    }
+
+    return written;
+}
+
+#if SIMD_X64
+
+// Two halves of 4 per plane to keep the same order as the others
+static int planesSSE(const BodyChunk& chunk, int count, const PlanePass::PlaneList& planes, std::vector<Contact>& out, int written)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128 x[2], y[2], radius[2], halfX[2], halfY[2];
+
+        for (int h = 0; h < 2; h++)
+        {
+            x[h] = _mm_load_ps(chunk.x + i + h * 4);
+            y[h] = _mm_load_ps(chunk.y + i + h * 4);
+            radius[h] = _mm_load_ps(chunk.radius + i + h * 4);
+            halfX[h] = _mm_load_ps(chunk.halfX + i + h * 4);
+            halfY[h] = _mm_load_ps(chunk.halfY + i + h * 4);
+        }
+
+        for (int p = 0; p < planes.body.size(); p++)
+        {
+            __m128 nx = _mm_set1_ps(planes.normalX[p]);
+            __m128 ny = _mm_set1_ps(planes.normalY[p]);
+            __m128 absX = _mm_set1_ps(fabsf(planes.normalX[p]));
+            __m128 absY = _mm_set1_ps(fabsf(planes.normalY[p]));
+            __m128 px = _mm_set1_ps(planes.x[p]);
+            __m128 py = _mm_set1_ps(planes.y[p]);
+
+            alignas(16) float lanes[3][8];
+            int touching = 0;
+
+            for (int h = 0; h < 2; h++)
+            {
+                __m128 reach = _mm_add_ps(_mm_add_ps(radius[h], _mm_mul_ps(absX, halfX[h])), _mm_mul_ps(absY, halfY[h]));
+                __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(x[h], px), nx), _mm_mul_ps(_mm_sub_ps(y[h], py), ny));
+                __m128 penetration = _mm_sub_ps(reach, distance);
+                __m128 inner = _mm_sub_ps(reach, _mm_mul_ps(penetration, half));
+
+                touching |= _mm_movemask_ps(_mm_cmpgt_ps(penetration, zero)) << (h * 4);
+
+                _mm_store_ps(lanes[0] + h * 4, _mm_sub_ps(x[h], _mm_mul_ps(nx, inner)));
+                _mm_store_ps(lanes[1] + h * 4, _mm_sub_ps(y[h], _mm_mul_ps(ny, inner)));
+                _mm_store_ps(lanes[2] + h * 4, penetration);
+            }
+
+            if (touching == 0) continue;
+            if (out.size() < written + 8) out.resize(written + 8);
+
+            // Every lane gets written and only the touching ones get counted
+            for (int lane = 0; lane < 8; lane++)
+            {
+                writeContact(chunk, i + lane, planes, p, lanes[0][lane], lanes[1][lane], lanes[2][lane], out[written]);
+                written += (touching >> lane) & 1;
+            }
+        }
+    }
+
+    return written;
+}
+
+SIMD_AVX2_TARGET
+static int planesAVX2(const BodyChunk& chunk, int count, const PlanePass::PlaneList& planes, std::vector<Contact>& out, int written)
+{
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256 x = _mm256_load_ps(chunk.x + i);
+        __m256 y = _mm256_load_ps(chunk.y + i);
+        __m256 radius = _mm256_load_ps(chunk.radius + i);
+        __m256 halfX = _mm256_load_ps(chunk.halfX + i);
+        __m256 halfY = _mm256_load_ps(chunk.halfY + i);
+
+        for (int p = 0; p < planes.body.size(); p++)
+        {
+            __m256 nx = _mm256_set1_ps(planes.normalX[p]);
+            __m256 ny = _mm256_set1_ps(planes.normalY[p]);
+            __m256 absX = _mm256_set1_ps(fabsf(planes.normalX[p]));
+            __m256 absY = _mm256_set1_ps(fabsf(planes.normalY[p]));
+
+            __m256 reach = _mm256_add_ps(_mm256_add_ps(radius, _mm256_mul_ps(absX, halfX)), _mm256_mul_ps(absY, halfY));
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(planes.x[p])), nx),
+                _mm256_mul_ps(_mm256_sub_ps(y, _mm256_set1_ps(planes.y[p])), ny));
+            __m256 penetration = _mm256_sub_ps(reach, distance);
+
+            int touching = _mm256_movemask_ps(_mm256_cmp_ps(penetration, zero, _CMP_GT_OQ));
+            if (touching == 0) continue;
+
+            __m256 inner = _mm256_sub_ps(reach, _mm256_mul_ps(penetration, half));
+
+            alignas(32) float lanes[3][8];
+            _mm256_store_ps(lanes[0], _mm256_sub_ps(x, _mm256_mul_ps(nx, inner)));
+            _mm256_store_ps(lanes[1], _mm256_sub_ps(y, _mm256_mul_ps(ny, inner)));
+            _mm256_store_ps(lanes[2], penetration);
+
+            if (out.size() < written + 8) out.resize(written + 8);
+
+            for (int lane = 0; lane < 8; lane++)
+            {
+                writeContact(chunk, i + lane, planes, p, lanes[0][lane], lanes[1][lane], lanes[2][lane], out[written]);
+                written += (touching >> lane) & 1;
+            }
+        }
+    }
+
+    return written;
+}
+
+#endif
+
+void PlanePass::findContacts(const BodyStore& bodies, std::vector<Contact>& contacts, BroadphaseStats& stats,
+    JobSystem* jobs, SimdLevel level)
+{
+    if (bodies.halfspaces.empty()) return;
+    if (!SimdLevelSupported(level)) level = BestSimdLevel();
+
+    // The store already keeps halfspaces in their own array, this just flattens them for the kernels
+    int planeCount = (int)bodies.halfspaces.size();
+    planes.x.resize(planeCount);
+    planes.y.resize(planeCount);
+    planes.normalX.resize(planeCount);
+    planes.normalY.resize(planeCount);
+    planes.body.resize(planeCount);
+
+    for (int p = 0; p < planeCount; p++)
+    {
+        int owner = bodies.halfspaceOwner[p];
+        planes.x[p] = bodies.position[owner].x;
+        planes.y[p] = bodies.position[owner].y;
+        planes.normalX[p] = bodies.halfspaces[p].normal.x;
+        planes.normalY[p] = bodies.halfspaces[p].normal.y;
+        planes.body[p] = owner;
+    }
+
+    const int grainSize = 1024;
+    int chunkCount = JobChunkCount(bodies.size(), grainSize);
+    if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+
+    ParallelFor(jobs, bodies.size(), grainSize, [&](int begin, int end, int chunkIndex)
+    {
+        ChunkResult& result = chunks[chunkIndex];
+        result.bodiesTested = 0;
+
+        BodyChunk chunk;
+        int written = 0;
+
+        for (int next = begin; next < end;)
+        {
+            int count;
+            int padded = gatherChunk(bodies, &next, end, chunk, &count);
+            result.bodiesTested += count;
+
+            switch (level)
+            {
+#if SIMD_X64
+            case SIMD_AVX2: written = planesAVX2(chunk, padded, planes, result.contacts, written); break;
+            case SIMD_SSE: written = planesSSE(chunk, padded, planes, result.contacts, written); break;
+#endif
+            default: written = planesScalar(chunk, padded, planes, result.contacts, written); break;
+            }
+        }
+
+        result.contacts.resize(written);
+    });
+
+    for (int i = 0; i < chunkCount; i++)
+    {
+        contacts.insert(contacts.end(), chunks[i].contacts.begin(), chunks[i].contacts.end());
+        stats.pairsTested += chunks[i].bodiesTested * planeCount;
+        stats.pairsOverlapping += (int)chunks[i].contacts.size();
+    }
+}
@@ -0,0 +1,81 @@
+#include "profileoverlay.h"
+#include "profiler.h"
+#include "raygui.h"
+
+// Enough to tell the zones apart, they wrap around after this many
+static const Color zoneColors[] = { RED, ORANGE, GOLD, LIME, SKYBLUE, BLUE, VIOLET, PINK, MAROON, DARKGREEN, BEIGE, MAGENTA };
+static const int zoneColorCount = sizeof(zoneColors) / sizeof(zoneColors[0]);
+
+void DrawProfileOverlay(Profiler& profiler, Rectangle bounds, const char* tracePath)
+{
+    GuiPanel(bounds, "Profiler");
+
+    // Graph on the left, one line per zone, newest frame on the right. The scale follows the slowest frame shown
+    Rectangle graph = { bounds.x + 10, bounds.y + 34, bounds.width * 0.6f - 20, bounds.height - 80 };
+    DrawRectangleRec(graph, Fade(BLACK, 0.6f));
+
+    float scale = 1000.0f / 60.0f;
+    for (int i = 0; i < Profiler::historyLength; i++)
+    {
+        if (profiler.getFrameTime(i) > scale) scale = profiler.getFrameTime(i);
+    }
+
+    float step = graph.width / (Profiler::historyLength - 1);
+    float bottom = graph.y + graph.height;
+
+    // The 60 fps budget as a line across
+    float budget = bottom - graph.height * (1000.0f / 60.0f) / scale;
+    DrawLine((int)graph.x, (int)budget, (int)(graph.x + graph.width), (int)budget, Fade(WHITE, 0.4f));
+
+    auto plot = [&](Color color, auto timeAt)
+    {
+        for (int i = 1; i < Profiler::historyLength; i++)
+        {
+            float x0 = graph.x + graph.width - (i - 1) * step;
+            float x1 = graph.x + graph.width - i * step;
+            DrawLineV({ x0, bottom - graph.height * timeAt(i - 1) / scale }, { x1, bottom - graph.height * timeAt(i) / scale }, color);
+        }
+    };
+
+    plot(WHITE, [&](int framesAgo) { return profiler.getFrameTime(framesAgo); });
+
+    for (int zone = 0; zone < profiler.getZoneCount(); zone++)
+    {
+        plot(zoneColors[zone % zoneColorCount], [&](int framesAgo) { return profiler.getZoneTime(zone, framesAgo); });
+    }
+
+    DrawText(TextFormat("%.1f ms", scale), (int)graph.x + 4, (int)graph.y + 4, 10, WHITE);
+
+    // Legend with averages on the right
+    float legendX = bounds.x + bounds.width * 0.6f;
+    float y = bounds.y + 34;
+
+    DrawText(TextFormat("frame  %.2f ms", profiler.getFrameTime(0)), (int)legendX, (int)y, 10, WHITE);
+    y += 14;
+
+    for (int zone = 0; zone < profiler.getZoneCount() && y < bounds.y + bounds.height - 50; zone++)
+    {
+        DrawRectangle((int)legendX, (int)y + 1, 8, 8, zoneColors[zone % zoneColorCount]);
+        DrawText(TextFormat("%s  %.2f ms", profiler.getZoneName(zone), profiler.getAverageZoneTime(zone)), (int)legendX + 12, (int)y, 10, WHITE);
+        y += 14;
+    }
+
+    // Capture, then stop and write the file
+    Rectangle button = { bounds.x + 10, bounds.y + bounds.height - 36, 200, 26 };
+
+    if (!profiler.isCapturing())
+    {
+        if (GuiButton(button, "Capture trace"))
+            profiler.startCapture();
+        if (profiler.getCapturedCount() > 0)
+            DrawText(TextFormat("%i zones in %s", profiler.getCapturedCount(), tracePath), (int)button.x + 210, (int)button.y + 8, 10, WHITE);
+    }
+    else if (GuiButton(button, TextFormat("Stop and save (%i zones)", profiler.getCapturedCount())))
+    {
+        profiler.stopCapture();
+        profiler.writeChromeTrace(tracePath);
+    }
+
+    if (profiler.getDroppedCount() > 0)
+        DrawText(TextFormat("%lld dropped", profiler.getDroppedCount()), (int)(bounds.x + bounds.width - 90), (int)button.y + 8, 10, RED);
+}
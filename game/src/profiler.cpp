@@ -0,0 +1,157 @@
+#include "profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+// Power of two so the slot is just the low bits of the index
+static const int ringSize = 1 << 14;
+
+// Every field is atomic so a reader racing a writer that lapped it reads garbage rather than
+// undefined behaviour, and sequence tells it the garbage apart: it's index + 1 once the slot
+// holds event index, and moves on past that as soon as a later event claims the slot
+struct RingSlot
+{
+    std::atomic<long long> sequence{ 0 };
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<long long> start{ 0 };
+    std::atomic<long long> end{ 0 };
+    std::atomic<int> thread{ 0 };
+};
+
+bool profilingEnabled = false;
+
+static RingSlot ring[ringSize];
+static std::atomic<long long> writeIndex(0);
+static std::atomic<int> threadCount(0);
+static const std::chrono::steady_clock::time_point programStart = std::chrono::steady_clock::now();
+
+long long ProfileNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - programStart).count();
+}
+
+void ProfileRecord(const char* name, long long start, long long end)
+{
+    thread_local int thread = threadCount.fetch_add(1);
+
+    // Claiming a slot is the only shared write, everything after it is this thread's alone
+    long long index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    RingSlot& slot = ring[index & (ringSize - 1)];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.thread.store(thread, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame()
+{
+    long long now = ProfileNow();
+    long long written = writeIndex.load(std::memory_order_acquire);
+
+    // Lapped, everything older than one ring back is gone
+    if (written - readIndex > ringSize)
+    {
+        dropped += written - ringSize - readIndex;
+        readIndex = written - ringSize;
+    }
+
+    for (int i = 0; i < zones.size(); i++) zones[i].history[head] = 0;
+
+    for (; readIndex < written; readIndex++)
+    {
+        RingSlot& slot = ring[readIndex & (ringSize - 1)];
+        long long sequence = slot.sequence.load(std::memory_order_acquire);
+
+        // Claimed but not filled in yet, pick it up next frame
+        if (sequence == 0 || sequence < readIndex + 1) break;
+
+        ProfileEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start = slot.start.load(std::memory_order_relaxed);
+        event.end = slot.end.load(std::memory_order_relaxed);
+        event.thread = slot.thread.load(std::memory_order_relaxed);
+
+        // Only counts if nobody took the slot over while it was being read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence != readIndex + 1 || slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            dropped++;
+            continue;
+        }
+
+        zones[findZone(event.name)].history[head] += (event.end - event.start) * 1e-6f;
+
+        if (capturing && captured.size() < captureLimit) captured.push_back(event);
+    }
+
+    frameHistory[head] = frameStart >= 0 ? (now - frameStart) * 1e-6f : 0;
+    frameStart = now;
+
+    head = (head + 1) % historyLength;
+    if (framesRecorded < historyLength) framesRecorded++;
+}
+
+// Zones get looked up by pointer, there's only ever a handful of them
+int Profiler::findZone(const char* name)
+{
+    for (int i = 0; i < zones.size(); i++)
+    {
+        if (zones[i].name == name) return i;
+    }
+
+    zones.emplace_back();
+    zones.back().name = name;
+    return (int)zones.size() - 1;
+}
+
+float Profiler::getZoneTime(int zone, int framesAgo) const
+{
+    if (framesAgo >= framesRecorded) return 0;
+    return zones[zone].history[(head - 1 - framesAgo + historyLength) % historyLength];
+}
+
+float Profiler::getAverageZoneTime(int zone) const
+{
+    if (framesRecorded == 0) return 0;
+
+    float total = 0;
+    for (int i = 0; i < framesRecorded; i++) total += getZoneTime(zone, i);
+    return total / framesRecorded;
+}
+
+float Profiler::getFrameTime(int framesAgo) const
+{
+    if (framesAgo >= framesRecorded) return 0;
+    return frameHistory[(head - 1 - framesAgo + historyLength) % historyLength];
+}
+
+void Profiler::startCapture(int maxEvents)
+{
+    captured.clear();
+    captureLimit = maxEvents;
+    capturing = true;
+}
+
+bool Profiler::writeChromeTrace(const char* path) const
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) return false;
+
+    // Complete events ("ph": "X") with microsecond times, nested zones stack up by themselves in the viewer
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+    for (int i = 0; i < captured.size(); i++)
+    {
+        const ProfileEvent& event = captured[i];
+        fprintf(file, "{\"name\": \"%s\", \"cat\": \"physics\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+            event.name, event.thread, event.start * 1e-3, (event.end - event.start) * 1e-3, i + 1 < captured.size() ? "," : "");
+    }
+
+    fprintf(file, "]}\n");
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,61 @@
+#include "simd.h"
+
+#if SIMD_X64
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // The OS has to save the ymm registers too, not just the CPU supporting them
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+bool SimdLevelSupported(SimdLevel level)
+{
+    switch (level)
+    {
+    case SIMD_SCALAR: return true;
+#if SIMD_X64
+    case SIMD_SSE: return true;
+    case SIMD_AVX2:
+    {
+        static const bool hasAVX2 = cpuHasAVX2();
+        return hasAVX2;
+    }
+#endif
+    default: return false;
+    }
+}
+
+SimdLevel BestSimdLevel()
+{
+    static const SimdLevel best =
+        SimdLevelSupported(SIMD_AVX2) ? SIMD_AVX2 :
+        SimdLevelSupported(SIMD_SSE) ? SIMD_SSE : SIMD_SCALAR;
+    return best;
+}
+
+const char* SimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_SSE: return "sse";
+    case SIMD_AVX2: return "avx2";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,252 @@
+#include "solver.h"
+#include "bodystore.h"
+#include "jobs.h"
+#include "raymath.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+static bool pairLess(const ContactManifold& x, const ContactManifold& y)
+{
+    return x.a != y.a ? x.a < y.a : x.b < y.b;
+}
+
+void ContactSolver::solve(BodyStore& bodies, const std::vector<Contact>& contacts, float dt, JobSystem* jobs)
+{
+    previous.swap(manifolds);
+    manifolds.clear();
+
+    // Warm starting walks last frame's list in order
+    if (manifoldsUnsorted) std::sort(previous.begin(), previous.end(), pairLess);
+    manifoldsUnsorted = false;
+
+    for (int i = 0; i < contacts.size(); i++)
+    {
+        const Contact& contact = contacts[i];
+
+        // Two static bodies can't push each other anywhere
+        if (bodies.invMass[contact.a] + bodies.invMass[contact.b] <= 0.0f) continue;
+
+        ContactManifold manifold;
+        manifold.a = contact.a;
+        manifold.b = contact.b;
+        manifold.normal = contact.normal;
+        manifold.point = contact.point;
+        manifold.penetration = contact.penetration;
+        manifolds.push_back(manifold);
+    }
+
+    // Sleeping pairs never reach the narrowphase, keep what they had
+    for (int i = 0; i < previous.size(); i++)
+    {
+        const ContactManifold& old = previous[i];
+
+        if (!bodies.isAwake(old.a) && !bodies.isAwake(old.b) && (!bodies.isStatic(old.a) || !bodies.isStatic(old.b)))
+        {
+            manifolds.push_back(old);
+            manifolds.back().asleep = true;
+        }
+    }
+
+    std::sort(manifolds.begin(), manifolds.end(), pairLess);
+
+    // Both lists are sorted so matching last frame's pairs is one walk through them
+    int old = 0;
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        ContactManifold& manifold = manifolds[i];
+        if (manifold.asleep) continue;
+
+        while (old < previous.size() && pairLess(previous[old], manifold)) old++;
+
+        // Only reuse the impulses if the pair is still touching the same way,
+        // a block sliding off a corner flips its normal and starts over
+        if (warmStarting && old < previous.size() && previous[old].a == manifold.a && previous[old].b == manifold.b &&
+            Vector2DotProduct(previous[old].normal, manifold.normal) > 0.95f)
+        {
+            manifold.normalImpulse = previous[old].normalImpulse;
+            manifold.tangentImpulse = previous[old].tangentImpulse;
+        }
+
+        int a = manifold.a;
+        int b = manifold.b;
+
+        // Nothing rotates, so the effective mass is just the inverse masses added up
+        manifold.normalMass = 1.0f / (bodies.invMass[a] + bodies.invMass[b]);
+        manifold.friction = sqrtf(bodies.material[a].coefficientOfFriction * bodies.material[b].coefficientOfFriction);
+
+        float closingVelocity = Vector2DotProduct(bodies.velocity[b] - bodies.velocity[a], manifold.normal);
+        float restitution = bodies.material[a].bounciness * bodies.material[b].bounciness;
+        manifold.velocityBias = (closingVelocity < -restitutionThreshold) ? -restitution * closingVelocity : 0.0f;
+    }
+
+    graph.build(bodies, manifolds);
+    graph.groupManifolds(manifolds, islandOrder, islandStarts);
+
+    if (dt > 0.0f) pseudoVelocity.assign(bodies.size(), { 0, 0 });
+
+    int islandCount = (int)islandStarts.size() - 1;
+
+    ParallelFor(jobs, islandCount, 8, [&](int begin, int end, int chunk)
+    {
+        for (int island = begin; island < end; island++)
+        {
+            solveIsland(bodies, islandStarts[island], islandStarts[island + 1], dt);
+        }
+    });
+
+    if (dt > 0.0f)
+    {
+        for (int i = 0; i < bodies.size(); i++)
+        {
+            bodies.position[i] += pseudoVelocity[i] * dt;
+        }
+    }
+}
+
+void ContactSolver::solveIsland(BodyStore& bodies, int first, int last, float dt)
+{
+    warmStart(bodies, first, last);
+
+    for (int i = 0; i < velocityIterations; i++)
+    {
+        solveVelocities(bodies, first, last);
+    }
+
+    solvePositions(bodies, first, last, dt);
+}
+
+// Static bodies can sit in several islands at once, so they only ever get read. Their
+// invMass is 0 so writing them back wouldn't change anything anyway
+void ContactSolver::warmStart(BodyStore& bodies, int first, int last)
+{
+    for (int i = first; i < last; i++)
+    {
+        const ContactManifold& manifold = manifolds[islandOrder[i]];
+        float invA = bodies.invMass[manifold.a];
+        float invB = bodies.invMass[manifold.b];
+
+        Vector2 tangent = { -manifold.normal.y, manifold.normal.x };
+        Vector2 impulse = manifold.normal * manifold.normalImpulse + tangent * manifold.tangentImpulse;
+
+        if (invA != 0.0f) bodies.velocity[manifold.a] -= impulse * invA;
+        if (invB != 0.0f) bodies.velocity[manifold.b] += impulse * invB;
+    }
+}
+
+void ContactSolver::solveVelocities(BodyStore& bodies, int first, int last)
+{
+    for (int i = first; i < last; i++)
+    {
+        ContactManifold& manifold = manifolds[islandOrder[i]];
+
+        Vector2 velocityA = bodies.velocity[manifold.a];
+        Vector2 velocityB = bodies.velocity[manifold.b];
+        float invA = bodies.invMass[manifold.a];
+        float invB = bodies.invMass[manifold.b];
+        Vector2 tangent = { -manifold.normal.y, manifold.normal.x };
+
+        // Friction first, it's limited by the normal impulse so it can't hold more than the contact pushes
+        float tangentSpeed = Vector2DotProduct(velocityB - velocityA, tangent);
+        float maxFriction = manifold.friction * manifold.normalImpulse;
+        float newTangentImpulse = Clamp(manifold.tangentImpulse - manifold.normalMass * tangentSpeed, -maxFriction, maxFriction);
+        Vector2 frictionImpulse = tangent * (newTangentImpulse - manifold.tangentImpulse);
+        manifold.tangentImpulse = newTangentImpulse;
+
+        velocityA -= frictionImpulse * invA;
+        velocityB += frictionImpulse * invB;
+
+        // Contacts can push but never pull, so the running total stays positive
+        float normalSpeed = Vector2DotProduct(velocityB - velocityA, manifold.normal);
+        float newNormalImpulse = fmaxf(manifold.normalImpulse - manifold.normalMass * (normalSpeed - manifold.velocityBias), 0.0f);
+        Vector2 normalImpulse = manifold.normal * (newNormalImpulse - manifold.normalImpulse);
+        manifold.normalImpulse = newNormalImpulse;
+
+        velocityA -= normalImpulse * invA;
+        velocityB += normalImpulse * invB;
+
+        if (invA != 0.0f) bodies.velocity[manifold.a] = velocityA;
+        if (invB != 0.0f) bodies.velocity[manifold.b] = velocityB;
+    }
+}
+
+// Same constraint again on a throwaway velocity that only moves positions,
+// so pushing bodies apart doesn't leave them flying away from each other
+void ContactSolver::solvePositions(BodyStore& bodies, int first, int last, float dt)
+{
+    if (dt <= 0.0f) return;
+
+    for (int iteration = 0; iteration < positionIterations; iteration++)
+    {
+        for (int i = first; i < last; i++)
+        {
+            ContactManifold& manifold = manifolds[islandOrder[i]];
+
+            Vector2 velocityA = pseudoVelocity[manifold.a];
+            Vector2 velocityB = pseudoVelocity[manifold.b];
+            float invA = bodies.invMass[manifold.a];
+            float invB = bodies.invMass[manifold.b];
+
+            float targetSpeed = positionCorrection * fmaxf(manifold.penetration - linearSlop, 0.0f) / dt;
+            float separatingSpeed = Vector2DotProduct(velocityB - velocityA, manifold.normal);
+
+            float newImpulse = fmaxf(manifold.positionImpulse + manifold.normalMass * (targetSpeed - separatingSpeed), 0.0f);
+            Vector2 impulse = manifold.normal * (newImpulse - manifold.positionImpulse);
+            manifold.positionImpulse = newImpulse;
+
+            if (invA != 0.0f) pseudoVelocity[manifold.a] = velocityA - impulse * invA;
+            if (invB != 0.0f) pseudoVelocity[manifold.b] = velocityB + impulse * invB;
+        }
+    }
+}
+
+void ContactSolver::removeBody(int body, int movedFrom)
+{
+    int kept = 0;
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        ContactManifold manifold = manifolds[i];
+        if (manifold.a == body || manifold.b == body) continue;
+
+        if (manifold.a == movedFrom) manifold.a = body;
+        if (manifold.b == movedFrom) manifold.b = body;
+
+        // Pairs stay lowest index first. Swapping the ends flips the normal, and the tangent with it.
+        // The bodies swap roles too, so the two flips cancel and the tangent impulse stays as it is
+        if (manifold.a > manifold.b)
+        {
+            int a = manifold.a;
+            manifold.a = manifold.b;
+            manifold.b = a;
+            manifold.normal = manifold.normal * -1.0f;
+        }
+
+        manifolds[kept++] = manifold;
+    }
+
+    manifolds.resize(kept);
+
+    // The renamed pairs are out of order now, sorted once at the next solve however many bodies went
+    if (movedFrom != body) manifoldsUnsorted = true;
+}
+
+void ContactSolver::clear()
+{
+    manifolds.clear();
+    previous.clear();
+    manifoldsUnsorted = false;
+}
+
+void ContactSolver::save(SnapshotWriter& writer) const
+{
+    writer.array(manifolds);
+    writer.value(manifoldsUnsorted);
+}
+
+void ContactSolver::restore(SnapshotReader& reader)
+{
+    reader.array(manifolds);
+    reader.value(manifoldsUnsorted);
+}
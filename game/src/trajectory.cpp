@@ -0,0 +1,99 @@
+#include "trajectory.h"
+#include "raymath.h"
+#include "world.h"
+#include <cmath>
+
+TrajectoryHit PredictTrajectory(const PhysicsWorld& world, Vector2 start, Vector2 velocity, float radius, float dt, float maxTime,
+    std::vector<Vector2>* path)
+{
+    TrajectoryHit result;
+    Vector2 position = start;
+    int steps = (int)(maxTime / dt);
+
+    if (path != nullptr)
+    {
+        path->clear();
+        path->push_back(position);
+    }
+
+    for (int i = 0; i < steps; i++)
+    {
+        Vector2 motion = velocity * dt;
+        TimeOfImpact hit;
+        int body = world.circleCast(position, motion, radius, &hit);
+
+        if (body >= 0)
+        {
+            result.body = body;
+            result.position = position + motion * hit.fraction;
+            result.point = result.position - hit.normal * radius;
+            result.normal = hit.normal;
+            result.time = (i + hit.fraction) * dt;
+
+            if (path != nullptr) path->push_back(result.position);
+            return result;
+        }
+
+        position += motion;
+        velocity += world.gravity * dt;
+
+        if (path != nullptr) path->push_back(position);
+
+        // The world would have removed it by now
+        if (position.y > world.killY) break;
+    }
+
+    return result;
+}
+
+void SolveAim(const PhysicsWorld& world, Vector2 start, float radius, int target, float minSpeed, float maxSpeed, int speedSamples,
+    float dt, float maxTime, std::vector<AimSolution>& solutions)
+{
+    solutions.clear();
+    if (target < 0 || target >= world.bodies.size() || speedSamples < 1) return;
+
+    // Up is positive from here on, the world's y points down
+    Vector2 toTarget = world.bodies.position[target] - start;
+    float dx = toTarget.x;
+    float dy = -toTarget.y;
+    float g = world.gravity.y;
+
+    for (int s = 0; s < speedSamples; s++)
+    {
+        float speed = (speedSamples > 1) ? minSpeed + (maxSpeed - minSpeed) * s / (speedSamples - 1) : minSpeed;
+        float v2 = speed * speed;
+        float angles[2];
+        int angleCount = 0;
+
+        if (fabsf(g) < 1e-6f)
+        {
+            // No gravity, straight at it
+            angles[angleCount++] = atan2f(dy, dx);
+        }
+        else
+        {
+            // tan(angle) = (v^2 -+ sqrt(v^4 - g(g dx^2 + 2 dy v^2))) / (g dx), out of reach when that's negative.
+            // Dividing by g before atan2 rather than after keeps dx's sign on the x side, so the launch
+            // heads towards the target when gravity points up (g < 0) too
+            float discriminant = v2 * v2 - g * (g * dx * dx + 2 * dy * v2);
+            if (discriminant < 0) continue;
+
+            float root = sqrtf(discriminant);
+            angles[angleCount++] = atan2f((v2 - root) / g, dx);
+            if (root > 0) angles[angleCount++] = atan2f((v2 + root) / g, dx);
+        }
+
+        for (int a = 0; a < angleCount; a++)
+        {
+            Vector2 velocity = { speed * cosf(angles[a]), -speed * sinf(angles[a]) };
+            TrajectoryHit hit = PredictTrajectory(world, start, velocity, radius, dt, maxTime);
+            if (hit.body != target) continue;
+
+            // Same range as the slider, 0 to 360 instead of -180 to 180
+            float degrees = angles[a] * RAD2DEG;
+            if (degrees < 0) degrees += 360.0f;
+
+            solutions.push_back({ degrees, speed, hit.time });
+        }
+    }
+}
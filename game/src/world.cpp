@@ -0,0 +1,630 @@
+#include "world.h"
+#include "ccd.h"
+#include "debugdraw.h"
+#include "determinism.h"
+#include "integrator.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "raymath.h"
+#include <cstring>
+
+void PhysicsWorld::step(float dt)
+{
+    PROFILE_ZONE("step");
+
+    if (deterministic) SetDeterministicFloatEnvironment();
+
+    bodies.storePreviousPositions();
+
+    if (debugDraw != nullptr) debugDraw->clear();
+
+    {
+        PROFILE_ZONE("broadphase");
+        findPairs();
+        recordBounds();
+
+        wakeTouchedIslands();
+    }
+
+    // Narrowphase in parallel chunks of pairs, then every awake body against every halfspace
+    {
+        PROFILE_ZONE("narrowphase");
+        contacts.clear();
+        narrowphase.findContacts(bodies, candidatePairs, contacts, stats, jobs);
+    }
+
+    {
+        PROFILE_ZONE("planes");
+        planePass.findContacts(bodies, contacts, stats, jobs);
+        recordContacts();
+    }
+
+    // Every contact gets solved together instead of pair by pair
+    {
+        PROFILE_ZONE("solver");
+        solver.solve(bodies, contacts, dt, jobs);
+        recordContactForces(dt);
+    }
+
+    // Begin/persist/end for every touching pair, run after solving so the events carry this step's impulses
+    {
+        PROFILE_ZONE("pair cache");
+        pairCache.update(bodies, solver.getManifolds());
+    }
+
+    {
+        PROFILE_ZONE("islands");
+        islands.updateSleep(bodies, solver.getManifolds(), dt);
+    }
+
+    // Gravity, integration and clearing forces all happen in IntegrateBodies.
+    // Gravity is never stored in the force array, it gets added as an acceleration
+    {
+        PROFILE_ZONE("integrate");
+        recordForces();
+        IntegrateBodies(bodies, gravity, dt, jobs);
+    }
+
+    {
+        PROFILE_ZONE("bullets");
+        sweepBullets();
+
+        removeFallenBodies();
+    }
+
+    stepCount++;
+
+    if (deterministic)
+    {
+        stepHash = hashState();
+        rollingHash = HashCombine(rollingHash, stepHash);
+    }
+}
+
+int PhysicsWorld::addCircle(Vector2 pos, float radius, float mass)
+{
+    sweepAndPrune.markDirty();
+    return bodies.addCircle(pos, radius, mass);
+}
+
+int PhysicsWorld::addBlock(Vector2 pos, Vector2 halfExtents, float mass)
+{
+    sweepAndPrune.markDirty();
+    return bodies.addBlock(pos, halfExtents, mass);
+}
+
+int PhysicsWorld::addHalfspace(Vector2 pos, float rotationDegrees)
+{
+    sweepAndPrune.markDirty();
+    return bodies.addHalfspace(pos, rotationDegrees);
+}
+
+// Everything that remembers body indices has to hear about removals
+void PhysicsWorld::removeBody(int body)
+{
+    removeProxy(body);
+    bodies.remove(body);
+
+    // Queries before the next step go through the trees and unbounded list, so the body that
+    // took this index has to be found under it straight away rather than at the next syncTrees
+    int moved = bodies.size();
+    if (body < bodies.size() && bodies.proxyId[body] >= 0) treeFor(body).setUserData(bodies.proxyId[body], body);
+
+    for (int k = 0; k < unboundedBodies.size(); k++)
+    {
+        if (unboundedBodies[k] == body)
+        {
+            unboundedBodies[k] = unboundedBodies.back();
+            unboundedBodies.pop_back();
+            k--;
+        }
+        else if (unboundedBodies[k] == moved)
+        {
+            unboundedBodies[k] = body;
+        }
+    }
+
+    sweepAndPrune.markDirty();
+    solver.removeBody(body, bodies.size());
+}
+
+void PhysicsWorld::clear()
+{
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        removeProxy(i);
+    }
+
+    bodies.clear();
+    solver.clear();
+    pairCache.clear();
+    sweepAndPrune.markDirty();
+    candidatePairs.clear();
+    contacts.clear();
+
+    stepCount = 0;
+    stepHash = 0;
+    rollingHash = 0;
+
+    if (debugDraw != nullptr) debugDraw->clear();
+}
+
+void PhysicsWorld::saveSnapshot(WorldSnapshot& snapshot) const
+{
+    SnapshotWriter writer(snapshot.data);
+
+    bodies.save(writer);
+    staticTree.save(writer);
+    dynamicTree.save(writer);
+    solver.save(writer);
+    pairCache.save(writer);
+
+    writer.value(gravity);
+    writer.value(stepCount);
+    writer.value(stepHash);
+    writer.value(rollingHash);
+}
+
+// Everything else the world keeps gets rebuilt from the bodies at the start of the next step,
+// apart from what queries before then read: the bounds and the unbounded list
+bool PhysicsWorld::restoreSnapshot(const WorldSnapshot& snapshot)
+{
+    SnapshotReader reader(snapshot.data);
+
+    bodies.restore(reader);
+    staticTree.restore(reader);
+    dynamicTree.restore(reader);
+    solver.restore(reader);
+    pairCache.restore(reader);
+
+    reader.value(gravity);
+    reader.value(stepCount);
+    reader.value(stepHash);
+    reader.value(rollingHash);
+
+    // Half of it is in by now, so nothing of it can be trusted
+    if (!reader.finished())
+    {
+        clear();
+        return false;
+    }
+
+    bodies.computeBounds(bodyBounds);
+    unboundedBodies.assign(bodies.halfspaceOwner.begin(), bodies.halfspaceOwner.end());
+
+    sweepAndPrune.markDirty();
+    candidatePairs.clear();
+    contacts.clear();
+
+    if (debugDraw != nullptr) debugDraw->clear();
+    return true;
+}
+
+uint64_t PhysicsWorld::hashState() const
+{
+    uint64_t hash = HashCombine(0, bodies.size());
+
+    hash = HashBytes(bodies.position.data(), bodies.position.size() * sizeof(Vector2), hash);
+    hash = HashBytes(bodies.velocity.data(), bodies.velocity.size() * sizeof(Vector2), hash);
+    hash = HashBytes(bodies.asleep.data(), bodies.asleep.size(), hash);
+    hash = HashBytes(bodies.sleepTime.data(), bodies.sleepTime.size() * sizeof(float), hash);
+
+    // Normals come from sinf/cosf when the rotation changes, the one libm call that can differ between machines
+    hash = HashBytes(bodies.halfspaces.data(), bodies.halfspaces.size() * sizeof(HalfspaceShape), hash);
+
+    // Field by field, the manifold has padding in it
+    const std::vector<ContactManifold>& manifolds = solver.getManifolds();
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        const ContactManifold& manifold = manifolds[i];
+        uint32_t words[4] = { (uint32_t)manifold.a, (uint32_t)manifold.b };
+        memcpy(&words[2], &manifold.normalImpulse, sizeof(float));
+        memcpy(&words[3], &manifold.tangentImpulse, sizeof(float));
+        hash = HashBytes(words, sizeof(words), hash);
+    }
+
+    return hash;
+}
+
+DynamicAABBTree& PhysicsWorld::treeFor(int body)
+{
+    return bodies.isStatic(body) ? staticTree : dynamicTree;
+}
+
+void PhysicsWorld::removeProxy(int body)
+{
+    if (bodies.proxyId[body] < 0) return;
+
+    treeFor(body).destroyProxy(bodies.proxyId[body]);
+    bodies.proxyId[body] = -1;
+}
+
+// Moves every proxy to its body's current box. User data is the body's index,
+// refreshed here because removing bodies shifts the indices
+void PhysicsWorld::syncTrees()
+{
+    unboundedBodies.clear();
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (bodies.shape[i] == HALF_SPACE)
+        {
+            unboundedBodies.push_back(i);
+            continue;
+        }
+
+        int& proxyId = bodies.proxyId[i];
+
+        if (proxyId < 0)
+            proxyId = treeFor(i).createProxy(bodyBounds[i], i);
+        else
+            treeFor(i).moveProxy(proxyId, bodyBounds[i]);
+
+        treeFor(i).setUserData(proxyId, i);
+    }
+}
+
+// Each moving body queries both trees with its tight box. Bodies are independent so
+// they get split over the job system, each range writing its own list
+void PhysicsWorld::findTreePairs(std::vector<BroadphasePair>& pairs)
+{
+    pairs.clear();
+
+    const int grainSize = 256;
+    int chunkCount = JobChunkCount(bodies.size(), grainSize);
+    if (treeChunkPairs.size() < chunkCount) treeChunkPairs.resize(chunkCount);
+
+    ParallelFor(jobs, bodies.size(), grainSize, [&](int begin, int end, int chunk)
+    {
+        std::vector<BroadphasePair>& out = treeChunkPairs[chunk];
+        out.clear();
+
+        for (int i = begin; i < end; i++)
+        {
+            if (bodies.isStatic(i) || bodies.proxyId[i] < 0) continue;
+
+            const AABB& box = bodyBounds[i];
+
+            // Moving vs moving shows up from both sides, keep the one where i is lower
+            dynamicTree.queryAABB(box, [&](int proxyId)
+            {
+                int j = dynamicTree.getUserData(proxyId);
+                if (j > i && AABBOverlap(box, bodyBounds[j])) out.push_back({ i, j });
+                return true;
+            });
+
+            staticTree.queryAABB(box, [&](int proxyId)
+            {
+                int j = staticTree.getUserData(proxyId);
+                if (AABBOverlap(box, bodyBounds[j])) out.push_back({ i < j ? i : j, i < j ? j : i });
+                return true;
+            });
+        }
+    });
+
+    AppendChunks(treeChunkPairs, chunkCount, pairs);
+
+    SortPairs(pairs);
+}
+
+// Broadphase: only pairs whose boxes overlap make it to the narrowphase. Halfspaces are left to the plane pass
+void PhysicsWorld::findPairs()
+{
+    bodies.computeBounds(bodyBounds);
+
+    syncTrees();
+
+    switch (broadphaseMode)
+    {
+    case BROADPHASE_BRUTE_FORCE: BruteForcePairs(bodyBounds, candidatePairs); break;
+    case BROADPHASE_GRID: grid.findPairs(bodyBounds, candidatePairs); break;
+    case BROADPHASE_SWEEP_AND_PRUNE: sweepAndPrune.findPairs(bodyBounds, candidatePairs, jobs); break;
+    case BROADPHASE_AABB_TREE: findTreePairs(candidatePairs); break;
+    }
+}
+
+// Anything awake overlapping a sleeping body wakes its whole island before the narrowphase,
+// so the island gets its contacts back this step instead of falling through for a frame
+void PhysicsWorld::wakeTouchedIslands()
+{
+    bodiesToWake.clear();
+
+    for (int p = 0; p < candidatePairs.size(); p++)
+    {
+        int a = candidatePairs[p].a;
+        int b = candidatePairs[p].b;
+
+        if (bodies.isAwake(a) && bodies.asleep[b]) bodiesToWake.push_back(b);
+        if (bodies.isAwake(b) && bodies.asleep[a]) bodiesToWake.push_back(a);
+    }
+
+    islands.wake(bodies, bodiesToWake, solver.getManifolds());
+}
+
+// Each bullet sweeps from where it started the step to where integration put it, against
+// anything its swept box touches. If it would have passed into something it gets moved back to
+// the first impact, just far enough in that the next step's narrowphase finds the contact and the
+// solver deals with the bounce and friction as usual. The rest of the step's motion is dropped.
+// Bullets go one at a time in index order, there are never many of them
+void PhysicsWorld::sweepBullets()
+{
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (!bodies.bullet[i] || bodies.shape[i] != CIRCLE || !bodies.isAwake(i)) continue;
+
+        Vector2 start = bodies.previousPosition[i];
+        Vector2 motion = bodies.position[i] - start;
+        if (motion.x == 0.0f && motion.y == 0.0f) continue;
+
+        float radius = bodies.circles[bodies.shapeIndex[i]].radius;
+        Vector2 end = bodies.position[i];
+        AABB swept = { Vector2Min(start, end) - Vector2{ radius, radius }, Vector2Max(start, end) + Vector2{ radius, radius } };
+
+        // Trees hold the boxes from the start of the step, moving bodies can't have gone far from them
+        sweepCandidates.clear();
+        auto collect = [&](const DynamicAABBTree& tree)
+        {
+            tree.queryAABB(swept, [&](int proxyId)
+            {
+                int j = tree.getUserData(proxyId);
+                if (j != i) sweepCandidates.push_back(j);
+                return true;
+            });
+        };
+
+        collect(dynamicTree);
+        collect(staticTree);
+        sweepCandidates.insert(sweepCandidates.end(), unboundedBodies.begin(), unboundedBodies.end());
+
+        TimeOfImpact first;
+        Vector2 firstRelativeMotion = {};
+
+        for (int k = 0; k < sweepCandidates.size(); k++)
+        {
+            int j = sweepCandidates[k];
+            Vector2 otherStart = bodies.previousPosition[j];
+            Vector2 otherMotion = bodies.position[j] - otherStart;
+            TimeOfImpact impact = circleTOI(j, start, motion, radius, otherStart, otherMotion);
+
+            if (impact.fraction >= 0 && (first.fraction < 0 || impact.fraction < first.fraction))
+            {
+                first = impact;
+                firstRelativeMotion = motion - otherMotion;
+            }
+        }
+
+        if (first.fraction < 0) continue;
+
+        // Go bulletOverlap deeper than first touch, measured along the normal
+        float closingPerFraction = -Vector2DotProduct(firstRelativeMotion, first.normal);
+        float fraction = closingPerFraction > 0.0f ? fminf(first.fraction + bulletOverlap / closingPerFraction, 1.0f) : first.fraction;
+
+        bodies.position[i] = start + motion * fraction;
+
+        if (debugDraw != nullptr && debugDraw->isEnabled(DEBUG_CONTACTS))
+        {
+            debugDraw->line(DEBUG_CONTACTS, start, bodies.position[i], 1, RED);
+            debugDraw->point(DEBUG_CONTACTS, bodies.position[i], 3, RED);
+        }
+    }
+}
+
+// A swept circle against one body, whatever its shape
+TimeOfImpact PhysicsWorld::circleTOI(int body, Vector2 start, Vector2 motion, float radius, Vector2 otherStart, Vector2 otherMotion) const
+{
+    switch (bodies.shape[body])
+    {
+    case CIRCLE:
+        return CircleCircleTOI(start, motion, radius, otherStart, otherMotion, bodies.circles[bodies.shapeIndex[body]].radius);
+    case BLOCK:
+        return CircleBlockTOI(start, motion, radius, otherStart, otherMotion, bodies.blocks[bodies.shapeIndex[body]].halfExtents);
+    case HALF_SPACE:
+        return CircleHalfspaceTOI(start, motion, radius, otherStart, bodies.halfspaces[bodies.shapeIndex[body]].normal);
+    }
+
+    return TimeOfImpact();
+}
+
+void PhysicsWorld::removeFallenBodies()
+{
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (bodies.shape[i] == HALF_SPACE) continue;
+
+        if (bodies.position[i].y > killY)
+        {
+            removeBody(i);
+            i--;
+        }
+    }
+}
+
+void PhysicsWorld::recordBounds()
+{
+    if (debugDraw == nullptr || !debugDraw->isEnabled(DEBUG_AABBS)) return;
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (bodies.shape[i] == HALF_SPACE) continue; // infinite box
+
+        Color color = bodies.isStatic(i) ? DARKGRAY : (bodies.asleep[i] ? GRAY : LIME);
+        debugDraw->box(DEBUG_AABBS, bodyBounds[i], 1, color);
+    }
+}
+
+void PhysicsWorld::recordContacts()
+{
+    if (debugDraw == nullptr || !debugDraw->isEnabled(DEBUG_CONTACTS)) return;
+
+    for (int i = 0; i < contacts.size(); i++)
+    {
+        const Contact& contact = contacts[i];
+        debugDraw->point(DEBUG_CONTACTS, contact.point, 3, YELLOW);
+        debugDraw->arrow(DEBUG_CONTACTS, contact.point, contact.point + contact.normal * 20.0f, 1, YELLOW);
+    }
+}
+
+// Contact forces on circles and blocks resting on a halfspace, worked out from what the solver applied this step
+void PhysicsWorld::recordContactForces(float dt)
+{
+    if (debugDraw == nullptr || !debugDraw->isEnabled(DEBUG_CONTACT_FORCES)) return;
+
+    const std::vector<ContactManifold>& manifolds = solver.getManifolds();
+
+    for (int i = 0; i < manifolds.size(); i++)
+    {
+        const ContactManifold& manifold = manifolds[i];
+
+        int resting;
+        float side; // the impulse pushes b along the normal and a against it
+        if (bodies.shape[manifold.a] == HALF_SPACE) { resting = manifold.b; side = 1.0f; }
+        else if (bodies.shape[manifold.b] == HALF_SPACE) { resting = manifold.a; side = -1.0f; }
+        else continue;
+
+        Vector2 restingPosition = bodies.position[resting];
+        Vector2 tangent = { -manifold.normal.y, manifold.normal.x };
+
+        Vector2 FNormal = manifold.normal * (side * manifold.normalImpulse / dt);
+        debugDraw->line(DEBUG_CONTACT_FORCES, restingPosition, restingPosition + FNormal, 2, GREEN);
+
+        // Friction
+        Vector2 Ffriction = tangent * (side * manifold.tangentImpulse / dt);
+        if (Vector2Length(Ffriction) > 0.0f)
+            debugDraw->line(DEBUG_CONTACT_FORCES, restingPosition, restingPosition + Ffriction, 2, ORANGE);
+    }
+}
+
+// Net force and gravity on every moving body, has to happen before integrating clears the forces
+void PhysicsWorld::recordForces()
+{
+    if (debugDraw == nullptr || !debugDraw->isEnabled(DEBUG_FORCES)) return;
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (bodies.invMass[i] == 0.0f) continue;
+
+        Vector2 position = bodies.position[i];
+        Vector2 FGravity = gravity * bodies.mass[i];
+        debugDraw->line(DEBUG_FORCES, position, position + bodies.force[i] + FGravity, 3, PINK);
+
+        // Draw gravity force
+        debugDraw->line(DEBUG_FORCES, position, position + FGravity, 2, PURPLE);
+    }
+}
+
+bool PhysicsWorld::pointInBody(int body, Vector2 point) const
+{
+    if (bodies.shape[body] == CIRCLE)
+        return Vector2Distance(point, bodies.position[body]) <= bodies.circles[bodies.shapeIndex[body]].radius;
+
+    return AABBOverlap(bodies.getAABB(body), { point, point });
+}
+
+int PhysicsWorld::pickBody(Vector2 point) const
+{
+    int best = -1;
+
+    auto visit = [&](const DynamicAABBTree& tree)
+    {
+        tree.queryPoint(point, [&](int proxyId)
+        {
+            int i = tree.getUserData(proxyId);
+            if (i > best && pointInBody(i, point)) best = i;
+            return true;
+        });
+    };
+
+    visit(dynamicTree);
+    visit(staticTree);
+
+    return best;
+}
+
+// Exact ray test against one body, fraction along direction or -1 on a miss
+float PhysicsWorld::raycastBody(int body, Vector2 origin, Vector2 direction, float maxFraction) const
+{
+    if (bodies.shape[body] == CIRCLE)
+    {
+        // |origin + direction * t - center| = radius
+        float radius = bodies.circles[bodies.shapeIndex[body]].radius;
+        Vector2 toOrigin = origin - bodies.position[body];
+        float a = Vector2DotProduct(direction, direction);
+        float b = 2.0f * Vector2DotProduct(direction, toOrigin);
+        float c = Vector2DotProduct(toOrigin, toOrigin) - radius * radius;
+
+        if (c <= 0) return 0; // starts inside
+        if (a <= 0) return -1;
+
+        float discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) return -1;
+
+        float t = (-b - sqrtf(discriminant)) / (2 * a);
+        return (t >= 0 && t <= maxFraction) ? t : -1;
+    }
+
+    float t;
+    if (RaycastAABB(origin, direction, maxFraction, bodies.getAABB(body), &t)) return t;
+    return -1;
+}
+
+int PhysicsWorld::raycast(Vector2 origin, Vector2 direction, Vector2* hitPoint) const
+{
+    int hitBody = -1;
+    float hitFraction = 1.0f;
+
+    auto visit = [&](const DynamicAABBTree& tree)
+    {
+        tree.raycast(origin, direction, hitFraction, [&](int proxyId, float maxFraction)
+        {
+            int body = tree.getUserData(proxyId);
+            float t = raycastBody(body, origin, direction, maxFraction);
+            if (t < 0) return maxFraction;
+
+            hitBody = body;
+            hitFraction = t;
+            return t;
+        });
+    };
+
+    visit(dynamicTree);
+    visit(staticTree);
+
+    if (hitBody >= 0) *hitPoint = origin + direction * hitFraction;
+    return hitBody;
+}
+
+int PhysicsWorld::circleCast(Vector2 start, Vector2 motion, float radius, TimeOfImpact* hit) const
+{
+    Vector2 end = start + motion;
+    AABB swept = { Vector2Min(start, end) - Vector2{ radius, radius }, Vector2Max(start, end) + Vector2{ radius, radius } };
+
+    int hitBody = -1;
+    TimeOfImpact first;
+
+    auto consider = [&](int body)
+    {
+        TimeOfImpact impact = circleTOI(body, start, motion, radius, bodies.position[body], { 0, 0 });
+        if (impact.fraction < 0 || (first.fraction >= 0 && impact.fraction >= first.fraction)) return;
+
+        first = impact;
+        hitBody = body;
+    };
+
+    auto visit = [&](const DynamicAABBTree& tree)
+    {
+        tree.queryAABB(swept, [&](int proxyId)
+        {
+            consider(tree.getUserData(proxyId));
+            return true;
+        });
+    };
+
+    visit(dynamicTree);
+    visit(staticTree);
+
+    for (int k = 0; k < unboundedBodies.size(); k++) consider(unboundedBodies[k]);
+
+    if (hitBody >= 0) *hit = first;
+    return hitBody;
+}
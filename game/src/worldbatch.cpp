@@ -0,0 +1,168 @@
+#include "worldbatch.h"
+#include "jobs.h"
+#include "raymath.h"
+#include <chrono>
+
+// Everything a world is set up with that a snapshot doesn't carry
+static void copySettings(const PhysicsWorld& from, PhysicsWorld& to)
+{
+    to.broadphaseMode = from.broadphaseMode;
+    to.killY = from.killY;
+    to.deterministic = from.deterministic;
+    to.bulletOverlap = from.bulletOverlap;
+
+    to.solver.velocityIterations = from.solver.velocityIterations;
+    to.solver.positionIterations = from.solver.positionIterations;
+    to.solver.warmStarting = from.solver.warmStarting;
+    to.solver.restitutionThreshold = from.solver.restitutionThreshold;
+    to.solver.linearSlop = from.solver.linearSlop;
+    to.solver.positionCorrection = from.solver.positionCorrection;
+
+    to.islands.sleepingEnabled = from.islands.sleepingEnabled;
+    to.islands.linearSleepTolerance = from.islands.linearSleepTolerance;
+    to.islands.timeToSleep = from.islands.timeToSleep;
+}
+
+void WorldBatch::reset(const PhysicsWorld& templateWorld, const std::vector<LaunchParameters>& launches)
+{
+    templateWorld.saveSnapshot(templateSnapshot);
+
+    const BodyStore& templateBodies = templateWorld.bodies;
+    towerBlocks.clear();
+    towerStarts.clear();
+
+    for (int i = 0; i < templateBodies.size(); i++)
+    {
+        if (templateBodies.shape[i] != BLOCK || templateBodies.isStatic(i)) continue;
+
+        towerBlocks.push_back(templateBodies.getHandle(i));
+        towerStarts.push_back(templateBodies.position[i]);
+    }
+
+    runs.resize(launches.size());
+
+    for (int i = 0; i < launches.size(); i++)
+    {
+        WorldRun& run = runs[i];
+        const LaunchParameters& launch = launches[i];
+
+        run.world.jobs = nullptr;
+        run.world.debugDraw = nullptr;
+        copySettings(templateWorld, run.world);
+        run.world.restoreSnapshot(templateSnapshot);
+
+        // Same as the game's spawnCircle
+        float rad = launch.angle * DEG2RAD;
+        int circle = run.world.addCircle(launch.position, launch.radius, launch.circleMass);
+        PhysicsCircle bird(&run.world.bodies, circle);
+        bird.material().coefficientOfFriction = 0.5f;
+        bird.projectileVelo() = { launch.speed * cosf(rad), -launch.speed * sinf(rad) };
+        bird.setBullet(launch.bullet);
+
+        run.launched = run.world.bodies.getHandle(circle);
+        run.outcome = LaunchOutcome();
+        run.settled = false;
+    }
+
+    worldSteps = 0;
+    seconds = 0;
+}
+
+void WorldBatch::stepWorld(WorldRun& run, float dt)
+{
+    PhysicsWorld& world = run.world;
+    BodyStore& bodies = world.bodies;
+
+    int launched = bodies.indexOf(run.launched);
+    float energyBefore = launched >= 0 ? 0.5f * bodies.mass[launched] * Vector2LengthSqr(bodies.velocity[launched]) : 0.0f;
+
+    world.step(dt);
+    run.outcome.steps++;
+
+    // First block the launched circle touches. Handles rather than indices, bodies may have
+    // been removed after the events were made
+    if (run.outcome.impactEnergy == 0)
+    {
+        const std::vector<ContactEvent>& begins = world.getPairCache().getBeginEvents();
+
+        for (int e = 0; e < begins.size(); e++)
+        {
+            BodyHandle other;
+            if (begins[e].handleA == run.launched) other = begins[e].handleB;
+            else if (begins[e].handleB == run.launched) other = begins[e].handleA;
+            else continue;
+
+            int otherIndex = bodies.indexOf(other);
+            if (otherIndex < 0 || bodies.shape[otherIndex] != BLOCK) continue;
+
+            run.outcome.impactEnergy = energyBefore;
+            break;
+        }
+    }
+
+    // Out of the arena is out of the world, or a circle sailing off sideways would keep it awake forever
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (bodies.isStatic(i) || AABBOverlap(arena, { bodies.position[i], bodies.position[i] })) continue;
+
+        world.removeBody(i);
+        i--;
+    }
+
+    for (int i = 0; i < bodies.size(); i++)
+    {
+        if (!bodies.isStatic(i) && !bodies.asleep[i]) return;
+    }
+
+    run.settled = true;
+    run.outcome.settleTime = run.outcome.steps * dt;
+}
+
+void WorldBatch::finishWorld(WorldRun& run)
+{
+    const BodyStore& bodies = run.world.bodies;
+    run.outcome.blocksToppled = 0;
+
+    for (int k = 0; k < towerBlocks.size(); k++)
+    {
+        int block = bodies.indexOf(towerBlocks[k]);
+        if (block < 0 || Vector2Distance(bodies.position[block], towerStarts[k]) > toppleDistance) run.outcome.blocksToppled++;
+    }
+}
+
+void WorldBatch::run(int maxSteps, float dt, JobSystem* jobs)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    long long stepsBefore = 0;
+    for (int i = 0; i < runs.size(); i++) stepsBefore += runs[i].outcome.steps;
+
+    // A few worlds per chunk, enough to keep the chunk count well above the thread count
+    const int grainSize = 4;
+    int worldCount = (int)runs.size();
+
+    for (int step = 0; step < maxSteps; step++)
+    {
+        ParallelFor(jobs, worldCount, grainSize, [&](int begin, int end, int chunk)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                if (!runs[i].settled) stepWorld(runs[i], dt);
+            }
+        });
+
+        bool anyMoving = false;
+        for (int i = 0; i < worldCount && !anyMoving; i++) anyMoving = !runs[i].settled;
+        if (!anyMoving) break;
+    }
+
+    worldSteps = -stepsBefore;
+
+    for (int i = 0; i < worldCount; i++)
+    {
+        finishWorld(runs[i]);
+        worldSteps += runs[i].outcome.steps;
+    }
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
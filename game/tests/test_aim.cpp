@@ -0,0 +1,69 @@
+// Aim solver tests, not part of the game build. Every launch SolveAim returns has to hit the target
+// first, whichever way the gravity slider points.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/tests/test_aim.cpp game/src/trajectory.cpp game/src/world.cpp game/src/profiler.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/aabbtree.cpp game/src/narrowphase.cpp game/src/solver.cpp game/src/islands.cpp game/src/integrator.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp game/src/ccd.cpp game/src/paircache.cpp game/src/planes.cpp -o test_aim -pthread
+//   ./test_aim
+
+#include "raylib.h"
+#include "trajectory.h"
+#include "world.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, float gravity, float targetY)
+{
+    printf("%s  %s (gravity %g, target y %g)\n", ok ? "ok  " : "FAIL", what, gravity, targetY);
+    if (!ok) failures++;
+}
+
+// A block off to the right of the launch point, level with it and then above and below it
+static void aimHitsTarget(float gravity, float targetY)
+{
+    PhysicsWorld world;
+    world.gravity = { 0, gravity };
+
+    int target = world.addBlock({ 400, targetY }, { 20, 20 }, 0);
+    world.bodies.setStatic(target, true);
+    world.step(1.0f / 60);
+
+    Vector2 start = { 0, 0 };
+    float radius = 10;
+    float dt = 1.0f / 60;
+    std::vector<AimSolution> solutions;
+    SolveAim(world, start, radius, target, 50, 600, 12, dt, 10, solutions);
+
+    check(!solutions.empty(), "finds launches that reach the target", gravity, targetY);
+
+    bool allHit = true;
+    bool allTowards = true;
+
+    for (const AimSolution& solution : solutions)
+    {
+        float angle = solution.angle * DEG2RAD;
+        Vector2 velocity = { solution.speed * cosf(angle), -solution.speed * sinf(angle) };
+
+        if (PredictTrajectory(world, start, velocity, radius, dt, 10).body != target) allHit = false;
+        if (velocity.x <= 0) allTowards = false;
+    }
+
+    check(allHit, "every launch hits the target first", gravity, targetY);
+    check(allTowards, "every launch heads towards the target", gravity, targetY);
+}
+
+int main()
+{
+    // The slider goes from -350 to 700, negative pulls up the screen
+    for (float gravity : { 200.0f, 700.0f, -200.0f, -350.0f })
+    {
+        for (float targetY : { 0.0f, -100.0f, 100.0f })
+        {
+            aimHitsTarget(gravity, targetY);
+        }
+    }
+
+    if (failures > 0) printf("%d failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
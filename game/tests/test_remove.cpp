@@ -0,0 +1,173 @@
+// Removal tests, not part of the game build. Removing a body renames whatever was last to its
+// index, and everything that remembers indices has to follow along without changing what it holds.
+//
+//   g++ -std=c++17 -O2 -Igame/include -Iraylib-5.5/src game/tests/test_remove.cpp game/src/world.cpp game/src/profiler.cpp game/src/bodystore.cpp game/src/broadphase.cpp game/src/aabbtree.cpp game/src/narrowphase.cpp game/src/solver.cpp game/src/islands.cpp game/src/integrator.cpp game/src/jobs.cpp game/src/simd.cpp game/src/determinism.cpp game/src/ccd.cpp game/src/paircache.cpp game/src/planes.cpp -o test_remove -pthread
+//   ./test_remove
+
+#include "raylib.h"
+#include "raymath.h"
+#include "world.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+// What warm starting hands each body at the start of the next step, by handle so it survives renaming
+struct WarmStartImpulse
+{
+    BodyHandle body;
+    Vector2 velocityChange;
+};
+
+static std::vector<WarmStartImpulse> warmStartImpulses(const PhysicsWorld& world)
+{
+    std::vector<WarmStartImpulse> result;
+
+    for (const ContactManifold& manifold : world.solver.getManifolds())
+    {
+        Vector2 tangent = { -manifold.normal.y, manifold.normal.x };
+        Vector2 impulse = manifold.normal * manifold.normalImpulse + tangent * manifold.tangentImpulse;
+
+        result.push_back({ world.bodies.getHandle(manifold.a), impulse * -world.bodies.invMass[manifold.a] });
+        result.push_back({ world.bodies.getHandle(manifold.b), impulse * world.bodies.invMass[manifold.b] });
+    }
+
+    return result;
+}
+
+// A block sliding along a floor, so its manifold carries friction, with the floor before it and
+// two bodies nobody touches around them. Removing the first moves the block ahead of the floor
+static void removalSwapsPairKeepsWarmStart()
+{
+    PhysicsWorld world;
+
+    world.addCircle({ -500, -500 }, 5, 0);
+    int floor = world.addBlock({ 0, 20 }, { 200, 20 }, 0);
+    world.addCircle({ 500, -500 }, 5, 0);
+    int block = world.addBlock({ 0, -10 }, { 10, 10 }, 1);
+    world.bodies.setStatic(floor, true);
+
+    for (int i = 0; i < 10; i++)
+    {
+        world.bodies.velocity[block] = { 50, world.bodies.velocity[block].y };
+        world.step(1.0f / 60);
+    }
+
+    BodyHandle blockHandle = world.bodies.getHandle(block);
+    std::vector<WarmStartImpulse> before = warmStartImpulses(world);
+
+    bool sliding = false;
+    for (const ContactManifold& manifold : world.solver.getManifolds())
+    {
+        if (manifold.a == floor && manifold.b == block && manifold.tangentImpulse != 0) sliding = true;
+    }
+    check(sliding, "block slides on the floor with friction");
+
+    world.removeBody(0);
+    check(world.bodies.indexOf(blockHandle) == 0, "block took the removed body's index");
+
+    // The pair's ends swapped, so look each body up rather than going by position in the list
+    std::vector<WarmStartImpulse> after = warmStartImpulses(world);
+    bool same = before.size() == after.size();
+
+    for (int i = 0; same && i < before.size(); i++)
+    {
+        bool found = false;
+        for (const WarmStartImpulse& other : after)
+        {
+            if (other.body == before[i].body && Vector2Distance(before[i].velocityChange, other.velocityChange) < 1e-6f) found = true;
+        }
+        same = found;
+    }
+    check(same, "warm start impulse on each body is the same after the pair got swapped");
+}
+
+// Picking and casting use the trees and unbounded list from the last step, so between a removal
+// and the next step they have to find the body that moved under its new index
+static void removalRenamesQueries()
+{
+    PhysicsWorld world;
+    world.gravity = { 0, 0 };
+
+    world.addCircle({ -100, 0 }, 5, 1);
+    world.addCircle({ 0, -100 }, 5, 1);
+    world.addCircle({ 100, 0 }, 5, 1);
+    world.step(1.0f / 60);
+
+    world.removeBody(0);
+    check(world.pickBody({ 100, 0 }) == 0, "pickBody finds the moved circle under its new index");
+    check(world.pickBody({ 0, -100 }) == 1, "pickBody still finds the circle that stayed put");
+
+    world.removeBody(1);
+    check(world.pickBody({ 100, 0 }) == 0, "removing the last body leaves the rest alone");
+    check(world.pickBody({ 0, -100 }) == -1, "and the removed one is gone");
+
+    world.addHalfspace({ 0, 100 }, 0);
+    world.step(1.0f / 60);
+
+    world.removeBody(0);
+    TimeOfImpact hit;
+    check(world.circleCast({ 0, 0 }, { 0, 200 }, 5, &hit) == 0, "circleCast finds the moved halfspace under its new index");
+}
+
+// Restoring brings back a body that was removed, and queries before the next step have to see it
+static void restoreRenamesQueries()
+{
+    PhysicsWorld world;
+    world.gravity = { 0, 0 };
+
+    world.addCircle({ 0, -100 }, 5, 1);
+    world.addHalfspace({ 0, 100 }, 0);
+    world.step(1.0f / 60);
+
+    WorldSnapshot snapshot;
+    world.saveSnapshot(snapshot);
+    world.removeBody(0);
+
+    check(world.restoreSnapshot(snapshot), "restores its own snapshot");
+
+    TimeOfImpact hit;
+    check(world.circleCast({ 0, 0 }, { 0, 200 }, 5, &hit) == 1, "circleCast finds the halfspace straight after a restore");
+    check(world.pickBody({ 0, -100 }) == 0, "pickBody finds the restored circle");
+}
+
+// Cut short or padded out, a snapshot gets refused rather than read past its end
+static void restoreRefusesBadSnapshot()
+{
+    PhysicsWorld world;
+    world.addCircle({ 0, -100 }, 5, 1);
+    world.addHalfspace({ 0, 100 }, 0);
+    world.step(1.0f / 60);
+
+    WorldSnapshot snapshot;
+    world.saveSnapshot(snapshot);
+
+    WorldSnapshot shortened = snapshot;
+    shortened.data.resize(snapshot.data.size() / 2);
+    check(!world.restoreSnapshot(shortened), "refuses a snapshot that's cut short");
+    check(world.bodies.size() == 0, "and leaves the world empty");
+
+    WorldSnapshot padded = snapshot;
+    padded.data.push_back(0);
+    check(!world.restoreSnapshot(padded), "refuses a snapshot with bytes left over");
+
+    check(world.restoreSnapshot(snapshot) && world.bodies.size() == 2, "still takes a good one afterwards");
+}
+
+int main()
+{
+    removalSwapsPairKeepsWarmStart();
+    removalRenamesQueries();
+    restoreRenamesQueries();
+    restoreRefusesBadSnapshot();
+
+    if (failures > 0) printf("%d failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
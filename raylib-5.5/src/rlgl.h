@@ -46,6 +46,9 @@
 *       #define RLGL_ENABLE_OPENGL_DEBUG_CONTEXT
 *           Enable debug context (only available on OpenGL 4.3)
 *
+*       #define RLGL_RENDER_STATS
+*           Count render batch flushes, draw calls and vertices, read them with rlGetRenderStats()
+*
 *       rlgl capabilities could be customized just defining some internal
 *       values before library inclusion (default values listed):
 *
@@ -422,6 +425,13 @@ typedef struct rlRenderBatch {
     float currentDepth;         // Current depth value for next draw
 } rlRenderBatch;
 
+// Render stats, only counted with RLGL_RENDER_STATS defined
+typedef struct rlRenderStats {
+    int batchFlushes;           // Number of times a render batch was drawn (rlDrawRenderBatch)
+    int drawCalls;              // Number of glDrawArrays()/glDrawElements() calls issued
+    int vertices;               // Number of vertices submitted
+} rlRenderStats;
+
 // OpenGL version
 typedef enum {
     RL_OPENGL_11 = 1,           // OpenGL 1.1
@@ -725,6 +735,8 @@ RLAPI void rlDrawRenderBatch(rlRenderBatch *batch);     // Draw render batch dat
 RLAPI void rlSetRenderBatchActive(rlRenderBatch *batch); // Set the active render batch for rlgl (NULL for default internal)
 RLAPI void rlDrawRenderBatchActive(void);               // Update and draw internal render batch
 RLAPI bool rlCheckRenderBatchLimit(int vCount);         // Check internal buffer overflow for a given number of vertex
+RLAPI rlRenderStats rlGetRenderStats(void);             // Get render stats counted since last reset (requires RLGL_RENDER_STATS)
+RLAPI void rlResetRenderStats(void);                    // Reset render stats
 
 RLAPI void rlSetTexture(unsigned int id);               // Set current texture for render batch and check buffers limits
 
@@ -1037,6 +1049,7 @@ RLAPI void rlLoadDrawQuad(void);     // Load and draw a quad
 typedef struct rlglData {
     rlRenderBatch *currentBatch;            // Current render batch
     rlRenderBatch defaultBatch;             // Default internal render batch
+    rlRenderStats stats;                    // Render stats (counted with RLGL_RENDER_STATS)
 
     struct {
         int vertexCounter;                  // Current active render batch vertex counter (generic, used for all batches)
@@ -2904,6 +2917,11 @@ void rlUnloadRenderBatch(rlRenderBatch batch)
 void rlDrawRenderBatch(rlRenderBatch *batch)
 {
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+#if defined(RLGL_RENDER_STATS)
+    RLGL.stats.batchFlushes++;
+    RLGL.stats.vertices += RLGL.State.vertexCounter;
+#endif
+
     // Update batch vertex buffers
     //------------------------------------------------------------------------------------------------------------
     // NOTE: If there is not vertex data, buffers doesn't need to be updated (vertexCount > 0)
@@ -3057,6 +3075,9 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
                 // Bind current draw call texture, activated as GL_TEXTURE0 and Bound to sampler2D texture0 by default
                 glBindTexture(GL_TEXTURE_2D, batch->draws[i].textureId);
 
+#if defined(RLGL_RENDER_STATS)
+                RLGL.stats.drawCalls++;
+#endif
                 if ((batch->draws[i].mode == RL_LINES) || (batch->draws[i].mode == RL_TRIANGLES)) glDrawArrays(batch->draws[i].mode, vertexOffset, batch->draws[i].vertexCount);
                 else
                 {
@@ -3171,6 +3192,28 @@ bool rlCheckRenderBatchLimit(int vCount)
     return overflow;
 }
 
+// Get render stats counted since last reset
+rlRenderStats rlGetRenderStats(void)
+{
+    rlRenderStats stats = { 0 };
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    stats = RLGL.stats;
+#endif
+
+    return stats;
+}
+
+// Reset render stats
+void rlResetRenderStats(void)
+{
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    RLGL.stats.batchFlushes = 0;
+    RLGL.stats.drawCalls = 0;
+    RLGL.stats.vertices = 0;
+#endif
+}
+
 // Textures data management
 //-----------------------------------------------------------------------------------------
 // Convert image data to OpenGL texture (returns OpenGL valid Id)